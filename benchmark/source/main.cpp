@@ -0,0 +1,313 @@
+#include <fmt/format.h>
+#include <fmt/ranges.h>
+#include <spdlog/spdlog.h>
+#include <sudoku/batch.h>
+#include <sudoku/dlx.h>
+#include <sudoku/io.h>
+#include <sudoku/lanes.h>
+#include <sudoku/reader.h>
+#include <sudoku/stats.h>
+#include <sudoku/sudoku.h>
+#include <sudoku/version.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <cxxopts.hpp>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <new>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Every allocation of the process is counted so solves can report how many they make
+namespace {
+  std::atomic<size_t> allocations{0};
+}
+
+auto operator new(size_t size) -> void* {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void* ptr = std::malloc(size != 0 ? size : 1)) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+// Over-aligned types such as the lane buffers come through here
+auto operator new(size_t size, std::align_val_t align) -> void* {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  auto alignment = static_cast<size_t>(align);
+  // aligned_alloc wants a multiple of the alignment
+  size_t rounded = (std::max<size_t>(size, 1) + alignment - 1) / alignment * alignment;
+#ifdef _WIN32
+  void* ptr = _aligned_malloc(rounded, alignment);
+#else
+  void* ptr = std::aligned_alloc(alignment, rounded);
+#endif
+  if (ptr != nullptr) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+// Kept out of line, inlined into the standard allocators GCC flags the malloc/free pairing
+[[gnu::noinline]] void operator delete(void* ptr) noexcept { std::free(ptr); }
+[[gnu::noinline]] void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+
+[[gnu::noinline]] void operator delete(void* ptr, std::align_val_t) noexcept {
+#ifdef _WIN32
+  _aligned_free(ptr);
+#else
+  std::free(ptr);
+#endif
+}
+[[gnu::noinline]] void operator delete(void* ptr, size_t, std::align_val_t align) noexcept {
+  operator delete(ptr, align);
+}
+
+namespace {
+
+  using Clock = std::chrono::steady_clock;
+
+  struct Corpus {
+    std::string name;
+    std::vector<std::string> puzzles;
+  };
+
+  // A solver configuration, solve() returns true if the puzzle was solved
+  struct Config {
+    std::string name;
+    std::function<bool(std::string_view)> solve;
+  };
+
+  struct Measurement {
+    size_t puzzles = 0;
+    size_t solved = 0;
+    double seconds = 0;
+    std::vector<double> latencies;  // microseconds, one per solve
+    size_t allocations = 0;
+  };
+
+  auto loadCorpus(const std::string& dir, const std::string& name) -> Corpus {
+    Corpus corpus{name, {}};
+    sudoku::PuzzleReader reader(dir + "/" + name + ".txt");
+    while (auto puzzle = reader.next()) {
+      corpus.puzzles.emplace_back(*puzzle);
+    }
+    return corpus;
+  }
+
+  // "Hidden Singles" -> "hidden-singles"
+  auto configName(std::string_view ruleName) -> std::string {
+    std::string name;
+    for (char c : ruleName) {
+      name += c == ' ' ? '-' : static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    return name;
+  }
+
+  auto percentile(const std::vector<double>& sorted, double fraction) -> double {
+    if (sorted.empty()) {
+      return 0;
+    }
+    auto rank = static_cast<size_t>(fraction * static_cast<double>(sorted.size() - 1));
+    return sorted[rank];
+  }
+
+  auto measure(const Config& config, const Corpus& corpus, size_t repeat) -> Measurement {
+    Measurement result;
+    result.latencies.reserve(corpus.puzzles.size() * repeat);
+    size_t allocationsBefore = allocations.load();
+    auto start = Clock::now();
+    for (size_t round = 0; round < repeat; round++) {
+      for (const auto& puzzle : corpus.puzzles) {
+        auto puzzleStart = Clock::now();
+        bool solved = config.solve(puzzle);
+        std::chrono::duration<double, std::micro> latency = Clock::now() - puzzleStart;
+        result.latencies.push_back(latency.count());
+        result.puzzles++;
+        result.solved += solved ? 1 : 0;
+      }
+    }
+    result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    // The latency vector was reserved up front, so what remains is the solvers' own
+    result.allocations = allocations.load() - allocationsBefore;
+    std::ranges::sort(result.latencies);
+    return result;
+  }
+
+  auto measurementToJson(const std::string& corpus, const std::string& config,
+                         const Measurement& m) -> std::string {
+    double puzzles = static_cast<double>(std::max<size_t>(m.puzzles, 1));
+    return fmt::format(
+        "{{\"corpus\":\"{}\",\"config\":\"{}\",\"puzzles\":{},\"solved\":{},"
+        "\"puzzles_per_second\":{:.1f},\"latency_us\":{{\"p50\":{:.2f},\"p90\":{:.2f},"
+        "\"p99\":{:.2f},\"max\":{:.2f}}},\"allocations_per_solve\":{:.2f}}}",
+        corpus, config, m.puzzles, m.solved, m.seconds > 0 ? puzzles / m.seconds : 0.0,
+        percentile(m.latencies, 0.5), percentile(m.latencies, 0.9), percentile(m.latencies, 0.99),
+        m.latencies.empty() ? 0.0 : m.latencies.back(),
+        static_cast<double>(m.allocations) / puzzles);
+  }
+
+}  // namespace
+
+auto main(int argc, char** argv) -> int {
+  spdlog::set_level(spdlog::level::warn);
+  cxxopts::Options options(*argv, "Sudoku solver benchmarks");
+
+  std::string corporaDir = SUDOKU_CORPORA_DIR;
+  std::string output;
+  size_t repeat = 3;
+  size_t threads = 0;
+
+  // clang-format off
+  options.add_options()
+    ("h,help", "Show help")
+    ("c,corpora", "Directory of the puzzle corpora", cxxopts::value(corporaDir))
+    ("r,repeat", "Times every corpus is solved per configuration", cxxopts::value(repeat))
+    ("t,threads", "Threads of the batch configuration, 0 for one per core",
+     cxxopts::value(threads))
+    ("o,output", "Write the JSON report to a file instead of stdout", cxxopts::value(output))
+  ;
+  // clang-format on
+
+  auto result = options.parse(argc, argv);
+  if (result["help"].as<bool>()) {
+    std::cout << options.help() << std::endl;
+    return 0;
+  }
+
+  std::vector<Corpus> corpora;
+  try {
+    for (const char* name : {"easy", "hard", "17clue", "hardest"}) {
+      corpora.push_back(loadCorpus(corporaDir, name));
+    }
+  } catch (const std::runtime_error& e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+
+  // Solvers are built once so the measurements only see per-puzzle work
+  std::optional<sudoku::Sudoku> game;
+  sudoku::DancingLinks links;
+  sudoku::LaneSolver lanes;
+  sudoku::SolveStats ruleStats;
+
+  auto solveRules = [&](std::string_view puzzle, sudoku::SolveMode mode,
+                        std::span<const sudoku::Rule> rules = sudoku::LOGIC_RULES,
+                        sudoku::Sweep sweep = sudoku::Sweep::All) {
+    if (game) {
+      game->load(puzzle);
+    } else {
+      game.emplace(puzzle, sudoku::History::None);
+    }
+    game->setRules(rules);
+    game->setSweep(sweep);
+    bool solved = game->solve(mode);
+    ruleStats += game->getSolveStats();
+    return solved;
+  };
+  auto solveLinks = [&](std::string_view puzzle) {
+    sudoku::Board solution;
+    return links.solve(sudoku::parseBoard(puzzle), 1, {&solution, 1}) == 1;
+  };
+  auto solveLanes = [&](std::string_view puzzle) {
+    sudoku::Board board = sudoku::parseBoard(puzzle);
+    sudoku::Board solution;
+    sudoku::LaneStatus status;
+    lanes.solve({&board, 1}, {&solution, 1}, {&status, 1});
+    // Stalled puzzles start over on the rules, as Engine::Lanes does in batch-lanes
+    if (status == sudoku::LaneStatus::Stalled) {
+      return solveRules(puzzle, sudoku::SolveMode::LogicThenSearch);
+    }
+    return status == sudoku::LaneStatus::Solved;
+  };
+
+  std::vector<Config> configs = {
+      {"rules-logic",
+       [&](std::string_view puzzle) { return solveRules(puzzle, sudoku::SolveMode::Logic); }},
+      {"rules-search",
+       [&](std::string_view puzzle) {
+         return solveRules(puzzle, sudoku::SolveMode::LogicThenSearch);
+       }},
+      {"rules-search-first",
+       [&](std::string_view puzzle) {
+         return solveRules(puzzle, sudoku::SolveMode::LogicThenSearch, sudoku::LOGIC_RULES,
+                           sudoku::Sweep::First);
+       }},
+      {"singles-search",
+       [&](std::string_view puzzle) {
+         return solveRules(puzzle, sudoku::SolveMode::LogicThenSearch, sudoku::SINGLES_RULES);
+       }},
+      {"dancing-links", solveLinks},
+      {"lanes", solveLanes},
+  };
+
+  // What each rule adds: logic only, the pipeline growing by one rule per configuration
+  for (size_t count = 1; count <= sudoku::LOGIC_RULES.size(); count++) {
+    auto rules = std::span(sudoku::LOGIC_RULES).first(count);
+    configs.push_back({"logic-to-" + configName(sudoku::ruleName(rules.back())),
+                       [&solveRules, rules](std::string_view puzzle) {
+                         return solveRules(puzzle, sudoku::SolveMode::Logic, rules);
+                       }});
+  }
+
+  std::vector<std::string> entries;
+  std::vector<std::string> ruleEntries;
+  for (const auto& corpus : corpora) {
+    spdlog::warn("Benchmarking {} ({} puzzles)", corpus.name, corpus.puzzles.size());
+    for (const auto& config : configs) {
+      ruleStats = {};
+      entries.push_back(measurementToJson(corpus.name, config.name,
+                                          measure(config, corpus, repeat)));
+      if (ruleStats.puzzles != 0) {
+        ruleEntries.push_back(fmt::format("{{\"corpus\":\"{}\",\"config\":\"{}\",\"stats\":{}}}",
+                                          corpus.name, config.name,
+                                          sudoku::statsToJson(ruleStats)));
+      }
+    }
+
+    // The whole corpus as one batch on all threads, latency is per batch here
+    std::vector<std::string_view> views(corpus.puzzles.begin(), corpus.puzzles.end());
+    const Corpus wholeCorpus{corpus.name, {""}};
+    for (auto [name, engine] : {std::pair{"batch-rules", sudoku::Engine::Rules},
+                                std::pair{"batch-dancing-links", sudoku::Engine::DancingLinks},
+                                std::pair{"batch-lanes", sudoku::Engine::Lanes}}) {
+      sudoku::BatchOptions batchOptions;
+      batchOptions.threads = threads;
+      batchOptions.engine = engine;
+      Config config{name, [&](std::string_view) {
+                      auto results = sudoku::solveBatch(views, batchOptions);
+                      return std::ranges::all_of(
+                          results, [](const sudoku::BatchResult& r) { return r.solved; });
+                    }};
+      Measurement m = measure(config, wholeCorpus, repeat);
+      m.puzzles *= corpus.puzzles.size();
+      m.solved *= corpus.puzzles.size();
+      entries.push_back(measurementToJson(corpus.name, config.name, m));
+    }
+  }
+
+  std::string json = fmt::format(
+      "{{\"version\":\"{}\",\"repeat\":{},\"results\":[\n  {}\n],\"rules\":[\n  {}\n]}}\n",
+      SUDOKU_VERSION, repeat, fmt::join(entries, ",\n  "), fmt::join(ruleEntries, ",\n  "));
+  if (output.empty()) {
+    std::cout << json;
+  } else {
+    std::ofstream file(output);
+    file << json;
+    file.close();
+    if (!file) {
+      std::cerr << "Could not write " << output << std::endl;
+      return 1;
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <sudoku/packed.h>
+#include <sudoku/stats.h>
+#include <sudoku/sudoku.h>
+
+#include <cstddef>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace sudoku {
+
+  /**
+   * @brief Solver used for every puzzle of a batch
+   */
+  enum class Engine {
+    Rules,         // Sudoku with the logical rules, see BatchOptions::mode
+    DancingLinks,  // DancingLinks exact cover, always solves
+    Lanes          // LaneSolver singles on 16 puzzles at once, stalled ones start over as Rules
+  };
+
+  struct BatchOptions {
+    size_t threads = 0;  // 0 for one per hardware thread
+    Engine engine = Engine::Rules;
+    SolveMode mode = SolveMode::LogicThenSearch;
+    std::vector<Rule> rules{LOGIC_RULES.begin(), LOGIC_RULES.end()};  // see Sudoku::setRules()
+    Sweep sweep = Sweep::All;  // nobody reads the steps of a batch
+    // If set, count solutions up to this limit instead of solving, 2 to check uniqueness
+    size_t countLimit = 0;
+  };
+
+  struct BatchResult {
+    std::string solution;  // 81 characters, '.' for unsolved cells, empty on error
+    bool solved = false;
+    std::string error;  // why the puzzle failed, parse errors included
+    size_t solutions = 0;  // with BatchOptions::countLimit, solutions found up to the limit
+  };
+
+  /**
+   * @brief Solves puzzles in parallel
+   * @details Each worker starts on an equal slice of the input and, when done, steals half of
+   * the largest remaining slice. Workers keep one solver each and reuse it for all their puzzles.
+   * A puzzle that does not parse or throws only sets the error of its own result.
+   *
+   * With BatchOptions::countLimit set every puzzle is counted instead, with DancingLinks for
+   * Engine::DancingLinks and Sudoku::countSolutions() otherwise. The solution is then the first
+   * one found and solved means there is at least one.
+   * @param stats if given, the rule counters of all workers are added to it. Only Engine::Rules
+   * runs rules, the other engines count puzzles only.
+   * @return one result per puzzle, in input order
+   */
+  auto solveBatch(std::span<const std::string_view> puzzles, const BatchOptions& options = {},
+                  SolveStats* stats = nullptr) -> std::vector<BatchResult>;
+
+  /**
+   * @brief Solves the records [first, first + count) of a packed corpus in parallel
+   * @details Workers decode their records straight from the mapping, so a block of a large
+   * corpus is solved without reading it into memory first. The range is clipped to the corpus.
+   */
+  auto solveBatch(const PackedReader& corpus, size_t first, size_t count,
+                  const BatchOptions& options = {}, SolveStats* stats = nullptr)
+      -> std::vector<BatchResult>;
+
+}  // namespace sudoku
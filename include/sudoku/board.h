@@ -0,0 +1,266 @@
+#pragma once
+
+#include <sudoku/tables.h>
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace sudoku {
+
+  const size_t ROWS = Classic::SIZE;
+  const size_t COLS = Classic::SIZE;
+  const size_t BOXES = Classic::SIZE;
+  const size_t CELLS = Classic::CELLS;
+
+  using Candidates = Classic::Candidates;
+
+  constexpr Candidates ALL_CANDIDATES = Classic::ALL_CANDIDATES;
+
+  // Mask holding only the given digit, counting from 1
+  template <typename Mask = Candidates> constexpr auto digitMask(int digit) -> Mask {
+    return static_cast<Mask>(1U << (digit - 1));
+  }
+
+  // Number of digits set in a mask
+  constexpr auto candidateCount(std::uint32_t candidates) -> int {
+    return std::popcount(candidates);
+  }
+
+  // Lowest digit set in a mask, only meaningful for non-empty masks
+  constexpr auto firstDigit(std::uint32_t candidates) -> int {
+    return std::countr_zero(candidates) + 1;
+  }
+
+  // Check if a digit is set in a mask
+  constexpr auto hasDigit(std::uint32_t candidates, int digit) -> bool {
+    return (candidates & (1U << (digit - 1))) != 0;
+  }
+
+  /**
+   * @brief One candidate removal, enough to undo it
+   *
+   * placed holds Change::PLACED if the removal solved the cell, plus the unit masks whose digit bit
+   * it set (a contradicting second placement of a digit sets none). A record with Change::POPPED
+   * and nothing removed marks a solved cell taken off the propagation queue.
+   */
+  template <size_t BOX_SIZE> struct BasicChange {
+    typename Geometry<BOX_SIZE>::CellIndex cell;
+    std::uint8_t placed;
+    typename Geometry<BOX_SIZE>::Candidates removed;
+
+    static constexpr std::uint8_t PLACED = 1;
+    static constexpr std::uint8_t ROW = 2;
+    static constexpr std::uint8_t COL = 4;
+    static constexpr std::uint8_t BOX = 8;
+    static constexpr std::uint8_t POPPED = 16;
+  };
+
+  template <size_t BOX> using BasicChangeLog = std::vector<BasicChange<BOX>>;
+
+  using Change = BasicChange<3>;
+  using ChangeLog = BasicChangeLog<3>;
+
+  /**
+   * @brief Compact board of candidate masks, BOX x BOX boxes of BOX x BOX cells
+   *
+   * Cells are stored row-major. Next to the candidates the board keeps, per row, column and box,
+   * the mask of digits already placed there (cells down to a single candidate). All mutation goes
+   * through removeCandidates()/keepOnly() so these masks never need a rescan.
+   *
+   * Every newly solved cell is also pushed onto a work queue (a bitset of cell indices) so
+   * propagation only has to visit the peers of cells that changed, see propagate().
+   *
+   * While changeLog is set every removal is appended to it and can be undone with rewind(), which
+   * is how search backtracks without copying boards.
+   */
+  template <size_t BOX> struct BasicBoard {
+    using Geometry = sudoku::Geometry<BOX>;
+    using Candidates = typename Geometry::Candidates;
+    using CellIndex = typename Geometry::CellIndex;
+    using Unit = typename Geometry::Unit;
+    using Change = BasicChange<BOX>;
+    using ChangeLog = BasicChangeLog<BOX>;
+
+    static constexpr size_t SIZE = Geometry::SIZE;
+    static constexpr size_t CELLS = Geometry::CELLS;
+    static constexpr Candidates ALL_CANDIDATES = Geometry::ALL_CANDIDATES;
+
+    std::array<Candidates, CELLS> cells;
+    std::array<Candidates, SIZE> rowDigits;
+    std::array<Candidates, SIZE> colDigits;
+    std::array<Candidates, SIZE> boxDigits;
+    std::array<std::uint64_t, (CELLS + 63) / 64> pending;
+    ChangeLog* changeLog = nullptr;
+
+    BasicBoard() {
+      cells.fill(ALL_CANDIDATES);
+      rowDigits.fill(0);
+      colDigits.fill(0);
+      boxDigits.fill(0);
+      pending.fill(0);
+    }
+
+    static constexpr auto index(size_t row, size_t col) -> size_t { return (row * SIZE) + col; }
+    static constexpr auto rowOf(size_t cell) -> size_t { return cell / SIZE; }
+    static constexpr auto colOf(size_t cell) -> size_t { return cell % SIZE; }
+    static constexpr auto boxOf(size_t cell) -> size_t {
+      return Geometry::boxOf(rowOf(cell), colOf(cell));
+    }
+
+    auto getCell(size_t cell) const -> Candidates { return cells[cell]; }
+    auto getCell(size_t row, size_t col) const -> Candidates { return cells[index(row, col)]; }
+
+    auto isSolved(size_t cell) const -> bool { return candidateCount(cells[cell]) == 1; }
+
+    // Digits placed in any of the units the cell belongs to
+    auto placedPeers(size_t cell) const -> Candidates {
+      return rowDigits[rowOf(cell)] | colDigits[colOf(cell)] | boxDigits[boxOf(cell)];
+    }
+
+    // Digits placed in a unit, see Geometry::rowUnit/colUnit/boxUnit for the numbering
+    auto unitDigits(size_t unit) const -> Candidates {
+      if (unit < SIZE) {
+        return rowDigits[unit];
+      }
+      if (unit < 2 * SIZE) {
+        return colDigits[unit - SIZE];
+      }
+      return boxDigits[unit - (2 * SIZE)];
+    }
+
+    // Remove candidates from a cell, returns true if anything was removed
+    auto removeCandidates(size_t cell, Candidates mask) -> bool {
+      Candidates before = cells[cell];
+      Candidates after = before & static_cast<Candidates>(~mask);
+      if (after == before) {
+        return false;
+      }
+      cells[cell] = after;
+      std::uint8_t placed = 0;
+      if (candidateCount(after) == 1) {
+        placed = place(cell, after);
+      }
+      if (changeLog != nullptr) {
+        changeLog->push_back(
+            {static_cast<CellIndex>(cell), placed, static_cast<Candidates>(before & mask)});
+      }
+      return true;
+    }
+
+    // Keep only candidates in mask, returns true if anything was removed
+    auto keepOnly(size_t cell, Candidates mask) -> bool {
+      return removeCandidates(cell, static_cast<Candidates>(ALL_CANDIDATES & ~mask));
+    }
+
+    // Undo logged changes until the change log is back to mark entries
+    void rewind(size_t mark) {
+      while (changeLog->size() > mark) {
+        const Change& change = changeLog->back();
+        if ((change.placed & Change::PLACED) != 0) {
+          auto digit = static_cast<Candidates>(~cells[change.cell]);
+          if ((change.placed & Change::ROW) != 0) {
+            rowDigits[rowOf(change.cell)] &= digit;
+          }
+          if ((change.placed & Change::COL) != 0) {
+            colDigits[colOf(change.cell)] &= digit;
+          }
+          if ((change.placed & Change::BOX) != 0) {
+            boxDigits[boxOf(change.cell)] &= digit;
+          }
+          pending[change.cell / 64] &= ~(std::uint64_t{1} << (change.cell % 64));
+        }
+        if ((change.placed & Change::POPPED) != 0) {
+          pending[change.cell / 64] |= std::uint64_t{1} << (change.cell % 64);
+        }
+        cells[change.cell] |= change.removed;
+        changeLog->pop_back();
+      }
+    }
+
+    // False if a cell has no candidates, a unit lacks a digit or a digit is placed twice in a unit
+    auto isConsistent() const -> bool {
+      for (const auto& unit : Geometry::UNIT_CELLS) {
+        Candidates seen = 0;
+        Candidates placed = 0;
+        for (auto cell : unit) {
+          if (cells[cell] == 0) {
+            return false;
+          }
+          seen |= cells[cell];
+          if (candidateCount(cells[cell]) == 1) {
+            if ((placed & cells[cell]) != 0) {
+              return false;
+            }
+            placed |= cells[cell];
+          }
+        }
+        if (seen != ALL_CANDIDATES) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    // Check if any solved cell still has to be propagated to its peers
+    auto hasPending() const -> bool {
+      std::uint64_t any = 0;
+      for (auto word : pending) {
+        any |= word;
+      }
+      return any != 0;
+    }
+
+    // Take the lowest queued solved cell off the work queue, only valid if hasPending()
+    auto popPending() -> size_t {
+      size_t word = 0;
+      while (pending[word] == 0) {
+        word++;
+      }
+      size_t bit = static_cast<size_t>(std::countr_zero(pending[word]));
+      pending[word] &= pending[word] - 1;
+      size_t cell = (word * 64) + bit;
+      if (changeLog != nullptr) {
+        changeLog->push_back({static_cast<CellIndex>(cell), Change::POPPED, 0});
+      }
+      return cell;
+    }
+
+    // Units are views into the constant unit table, nothing is allocated
+    static auto getUnit(size_t unit) -> const Unit& { return Geometry::UNIT_CELLS[unit]; }
+    static auto getRow(size_t row) -> const Unit& {
+      return Geometry::UNIT_CELLS[Geometry::rowUnit(row)];
+    }
+    static auto getCol(size_t col) -> const Unit& {
+      return Geometry::UNIT_CELLS[Geometry::colUnit(col)];
+    }
+    static auto getBlock(size_t row, size_t col) -> const Unit& {
+      return Geometry::UNIT_CELLS[Geometry::boxUnit(Geometry::boxOf(row, col))];
+    }
+
+  private:
+    // Record a solved cell, returns the Change::placed flags
+    auto place(size_t cell, Candidates digit) -> std::uint8_t {
+      std::uint8_t placed = Change::PLACED;
+      if ((rowDigits[rowOf(cell)] & digit) == 0) {
+        rowDigits[rowOf(cell)] |= digit;
+        placed |= Change::ROW;
+      }
+      if ((colDigits[colOf(cell)] & digit) == 0) {
+        colDigits[colOf(cell)] |= digit;
+        placed |= Change::COL;
+      }
+      if ((boxDigits[boxOf(cell)] & digit) == 0) {
+        boxDigits[boxOf(cell)] |= digit;
+        placed |= Change::BOX;
+      }
+      pending[cell / 64] |= std::uint64_t{1} << (cell % 64);
+      return placed;
+    }
+  };
+
+  using Board = BasicBoard<3>;
+
+}  // namespace sudoku
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <sudoku/board.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace sudoku {
+
+  /**
+   * @brief Dancing Links (Algorithm X) solver on the 324-column exact-cover model
+   *
+   * Columns are the cell, row/digit, column/digit and box/digit constraints, rows the 729
+   * (cell, digit) placements. The link arrays are built once in the constructor and solve()
+   * restores them on return, so a solver can be reused for any number of puzzles without
+   * allocating. The object is about 40 KB, keep one per thread rather than one per puzzle.
+   */
+  class DancingLinks {
+  public:
+    static constexpr size_t COLUMNS = 4 * CELLS;
+    static constexpr size_t PLACEMENTS = CELLS * 9;
+    static constexpr size_t NODES = 1 + COLUMNS + (4 * PLACEMENTS);
+
+    DancingLinks();
+
+    /**
+     * @brief Enumerates solutions of a puzzle
+     * @details Solved cells of the board are givens, the candidates of unsolved cells restrict
+     * which digits the search tries.
+     * @param puzzle the board to solve
+     * @param limit stop after this many solutions
+     * @param solutions receives the first solutions found, as many as fit
+     * @return the number of solutions found, at most limit
+     */
+    auto solve(const Board& puzzle, size_t limit = 1, std::span<Board> solutions = {}) -> size_t;
+
+  private:
+    using Node = std::uint16_t;
+
+    std::array<Node, NODES> left;
+    std::array<Node, NODES> right;
+    std::array<Node, NODES> up;
+    std::array<Node, NODES> down;
+    std::array<Node, NODES> column;
+    std::array<Node, NODES> placement;
+    std::array<Node, COLUMNS + 1> size;
+    std::array<Node, PLACEMENTS> firstNode;
+    std::array<bool, PLACEMENTS> allowed;
+    std::array<Node, CELLS> chosen;
+
+    size_t depth = 0;
+    size_t limit = 0;
+    size_t found = 0;
+    std::span<Board> solutions;
+
+    void cover(Node col);
+    void uncover(Node col);
+    void search();
+    void record();
+  };
+
+}  // namespace sudoku
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <sudoku/board.h>
+#include <sudoku/trace.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace sudoku {
+
+  /**
+   * @brief Which puzzles the generator keeps
+   *
+   * A puzzle's grade is the hardest rule it needs, see gradePuzzle(), and a puzzle is kept if
+   * its grade lies in [minGrade, maxGrade].
+   */
+  struct GeneratorOptions {
+    std::uint64_t seed = 0;  // the same seed gives the same puzzles, whatever the thread count
+    size_t threads = 0;      // 0 for one per hardware thread
+    Rule minGrade = Rule::Penciling;
+    Rule maxGrade = Rule::Search;
+    bool symmetric = true;  // remove clues in pairs mirrored through the center
+    size_t attempts = 100;  // full grids tried per puzzle before giving up on the grade band
+  };
+
+  struct GeneratedPuzzle {
+    Board puzzle;
+    Board solution;
+    Rule grade = Rule::Penciling;
+    size_t clues = 0;
+  };
+
+  /**
+   * @brief Grades a puzzle by the hardest rule it needs
+   * @details The rules of LOGIC_RULES are applied cheapest first, as Sudoku::solve() does, and
+   * the grade is the hardest one that fired, Rule::Search if they stall before the end.
+   */
+  auto gradePuzzle(const Board& puzzle) -> Rule;
+
+  /**
+   * @brief Parses a grade band
+   * @param spec "any", one rule name or "min:max", with "search" for puzzles the rules cannot
+   * finish, e.g. "pointing" or "hidden-singles:fish"
+   * @throws std::invalid_argument for unknown rules and an empty band
+   */
+  auto parseGradeBand(std::string_view spec) -> std::pair<Rule, Rule>;
+
+  /**
+   * @brief Generates one puzzle with a unique solution
+   * @details Fills a random grid, then removes clues in random order as long as the solution
+   * stays unique and the grade does not exceed options.maxGrade, which leaves a minimal puzzle
+   * for the band. Grids are drawn until the grade reaches options.minGrade.
+   * @return nothing if no grid of options.attempts made it into the grade band
+   */
+  auto generatePuzzle(std::uint64_t seed, const GeneratorOptions& options = {})
+      -> std::optional<GeneratedPuzzle>;
+
+  /**
+   * @brief Generates puzzles in parallel
+   * @details Puzzle i is the one generatePuzzle() makes from a seed derived from options.seed
+   * and i, so the result does not depend on the number of threads.
+   */
+  auto generatePuzzles(size_t count, const GeneratorOptions& options = {})
+      -> std::vector<std::optional<GeneratedPuzzle>>;
+
+}  // namespace sudoku
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <sudoku/board.h>
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace sudoku {
+
+  // Character of a digit, 1–9 and then letters from A for boards larger than 9x9
+  constexpr auto digitChar(int digit) -> char {
+    return static_cast<char>(digit <= 9 ? '0' + digit : 'A' + (digit - 10));
+  }
+
+  // Character of a cell, its digit once a single candidate is left and '.' otherwise
+  constexpr auto cellChar(std::uint32_t candidates) -> char {
+    return std::has_single_bit(candidates) ? digitChar(firstDigit(candidates)) : '.';
+  }
+
+  enum class ParseStatus : std::uint8_t {
+    Ok,
+    TooFewCells,
+    TooManyCells,
+    InvalidCharacter,
+  };
+
+  /**
+   * @brief Outcome of tryParseBoard(), offset and character point at the first offending input
+   */
+  struct ParseResult {
+    ParseStatus status = ParseStatus::Ok;
+    size_t offset = 0;
+    size_t cells = 0;  // cells read before stopping
+    char character = '\0';
+
+    auto ok() const -> bool { return status == ParseStatus::Ok; }
+  };
+
+  /**
+   * @brief Parses a sudoku row by row without allocating or throwing
+   * @details Cells are '.' or '0' for blanks and the digits, those above 9 as letters from A on
+   * in either case, so a 16x16 board uses 1–9 and A–G. Whitespace, '|', '-' and '+' between
+   * cells are skipped, so single lines as well as grids over several lines and the tables of
+   * boardToTable() are read. '#' starts a comment running to the end of the line.
+   * @param board receives the puzzle, only complete if the result is ok
+   */
+  template <size_t BOX>
+  auto tryParseBoard(std::string_view text, BasicBoard<BOX>& board) noexcept -> ParseResult;
+
+  // Describes a failed parse for error messages
+  auto parseErrorMessage(const ParseResult& result, size_t cells = CELLS) -> std::string;
+
+  /**
+   * @brief Parses a sudoku, see tryParseBoard() for the format
+   * @throws std::invalid_argument with parseErrorMessage() if the text is not a sudoku
+   */
+  template <size_t BOX = 3> auto parseBoard(std::string_view str) -> BasicBoard<BOX>;
+
+  /**
+   * @brief Writes a board one character per cell, '.' for unsolved cells
+   * @param out output iterator, e.g. a pointer into a buffer or a std::back_insert_iterator
+   * @return the iterator past the last character written
+   */
+  template <size_t BOX, typename Out> auto formatBoard(const BasicBoard<BOX>& board, Out out)
+      -> Out {
+    for (size_t cell = 0; cell < BasicBoard<BOX>::CELLS; cell++) {
+      *out++ = cellChar(board.getCell(cell));
+    }
+    return out;
+  }
+
+  /**
+   * @brief Writes a board into a caller's buffer without allocating
+   * @return the number of characters written, BasicBoard::CELLS, or 0 if the buffer is too small
+   */
+  template <size_t BOX>
+  auto writeBoard(const BasicBoard<BOX>& board, std::span<char> buffer) noexcept -> size_t {
+    if (buffer.size() < BasicBoard<BOX>::CELLS) {
+      return 0;
+    }
+    formatBoard(board, buffer.data());
+    return BasicBoard<BOX>::CELLS;
+  }
+
+  // Characters formatTable() writes for a board of BOX x BOX boxes
+  template <size_t BOX> constexpr size_t TABLE_SIZE
+      = (BOX * BOX * ((2 * BOX * BOX) + (2 * (BOX - 1)) + 1))  // rows of cells
+        + ((BOX - 1) * ((2 * BOX * BOX) + (2 * (BOX - 1))));  // separators between boxes
+
+  /**
+   * @brief Writes a board as a table with box separators, see formatBoard() for out
+   */
+  template <size_t BOX, typename Out> auto formatTable(const BasicBoard<BOX>& board, Out out)
+      -> Out {
+    for (size_t row = 0; row < BasicBoard<BOX>::SIZE; row++) {
+      if (row % BOX == 0 && row != 0) {
+        // Dashes under the cells of each box, crossing the vertical separators with '+'
+        for (size_t box = 0; box < BOX; box++) {
+          if (box != 0) {
+            *out++ = '+';
+          }
+          size_t width = (2 * BOX) + (box != 0 ? 1 : 0) - (box == BOX - 1 ? 1 : 0);
+          out = std::fill_n(out, width, '-');
+        }
+        *out++ = '\n';
+      }
+
+      for (size_t col = 0; col < BasicBoard<BOX>::SIZE; col++) {
+        if (col % BOX == 0 && col != 0) {
+          *out++ = '|';  // vertical separator
+          *out++ = ' ';
+        }
+        *out++ = cellChar(board.getCell(row, col));
+        *out++ = ' ';
+      }
+      *out++ = '\n';
+    }
+    return out;
+  }
+
+  /**
+   * @brief Formats a board one character per cell, '.' for unsolved cells
+   */
+  template <size_t BOX> auto boardToString(const BasicBoard<BOX>& board) -> std::string;
+
+  /**
+   * @brief Formats a board as a table with box separators
+   */
+  template <size_t BOX> auto boardToTable(const BasicBoard<BOX>& board) -> std::string;
+
+  extern template auto tryParseBoard(std::string_view, BasicBoard<2>&) noexcept -> ParseResult;
+  extern template auto tryParseBoard(std::string_view, BasicBoard<3>&) noexcept -> ParseResult;
+  extern template auto tryParseBoard(std::string_view, BasicBoard<4>&) noexcept -> ParseResult;
+  extern template auto tryParseBoard(std::string_view, BasicBoard<5>&) noexcept -> ParseResult;
+  extern template auto parseBoard<2>(std::string_view str) -> BasicBoard<2>;
+  extern template auto parseBoard<3>(std::string_view str) -> BasicBoard<3>;
+  extern template auto parseBoard<4>(std::string_view str) -> BasicBoard<4>;
+  extern template auto parseBoard<5>(std::string_view str) -> BasicBoard<5>;
+  extern template auto boardToString(const BasicBoard<2>& board) -> std::string;
+  extern template auto boardToString(const BasicBoard<3>& board) -> std::string;
+  extern template auto boardToString(const BasicBoard<4>& board) -> std::string;
+  extern template auto boardToString(const BasicBoard<5>& board) -> std::string;
+  extern template auto boardToTable(const BasicBoard<2>& board) -> std::string;
+  extern template auto boardToTable(const BasicBoard<3>& board) -> std::string;
+  extern template auto boardToTable(const BasicBoard<4>& board) -> std::string;
+  extern template auto boardToTable(const BasicBoard<5>& board) -> std::string;
+
+}  // namespace sudoku
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <sudoku/board.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace sudoku {
+
+  enum class LaneStatus : std::uint8_t {
+    Solved,   // every cell has a single candidate
+    Stalled,  // singles made no more progress, needs a scalar engine
+    Invalid   // a cell ran out of candidates or a unit cannot hold every digit
+  };
+
+  /**
+   * @brief Runs naked and hidden singles on many puzzles at once
+   *
+   * Candidates are stored structure-of-arrays, cells[cell][lane], so every step of the singles
+   * kernel is the same 16-bit operation across all lanes. The loops are written for the compiler to
+   * vectorize (SSE2 handles 8 lanes per instruction, AVX2 16, AVX-512 32), which keeps the code
+   * portable to targets without x86 intrinsics. Puzzles leave their lane as soon as they are solved,
+   * stall or turn out invalid, and the next puzzle takes the lane over.
+   *
+   * LANES is fixed at compile time rather than picked for the target, 16 lanes of 16-bit
+   * candidates fill one AVX2 register. The solver only knows singles: stalled puzzles are left to
+   * the caller, solveBatch() solves them again from the start with Sudoku, its rules and mode.
+   */
+  class LaneSolver {
+  public:
+    static constexpr size_t LANES = 16;
+
+    /**
+     * @brief Applies singles to every puzzle until it is solved, stalls or is invalid
+     * @param puzzles boards to solve
+     * @param results receives the reduced board of every puzzle
+     * @param status receives how every puzzle ended
+     */
+    void solve(std::span<const Board> puzzles, std::span<Board> results,
+               std::span<LaneStatus> status);
+
+  private:
+    using Lanes = std::array<Candidates, LANES>;
+
+    alignas(64) std::array<Lanes, CELLS> cells;
+
+    // Runs one round of singles, returns per lane whether a candidate was removed, whether a cell is
+    // still unsolved and whether the lane is invalid
+    void round(Lanes& changed, Lanes& unsolved, Lanes& invalid);
+  };
+
+}  // namespace sudoku
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <sudoku/board.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <span>
+#include <string>
+
+namespace sudoku {
+
+  /**
+   * @brief Binary corpus format for 9x9 boards
+   *
+   * A 16 byte header holds the magic "SDKP", the format version, the box size, the record size
+   * and the number of records, all little endian. Fixed size records follow, two cells per byte
+   * with the lower cell index in the low nibble, 0 for blanks and unsolved cells. A record takes
+   * 41 bytes against 82 for a text line, and record i starts at byte 16 + 41 * i.
+   */
+  inline constexpr size_t PACKED_HEADER_SIZE = 16;
+  inline constexpr size_t PACKED_RECORD_SIZE = (CELLS + 1) / 2;
+  inline constexpr std::uint8_t PACKED_VERSION = 1;
+
+  using PackedRecord = std::array<std::uint8_t, PACKED_RECORD_SIZE>;
+
+  auto packBoard(const Board& board) -> PackedRecord;
+
+  // Decodes a record without throwing, false for a nibble that is not a digit
+  auto tryUnpackBoard(std::span<const std::uint8_t, PACKED_RECORD_SIZE> record,
+                      Board& board) noexcept -> bool;
+
+  // Whether a file starts with the packed header magic
+  auto isPackedFile(const std::string& path) -> bool;
+
+  /**
+   * @brief Memory maps a packed corpus for random access to its records
+   *
+   * Records are decoded straight from the mapping, so the corpus only takes page cache and is
+   * shared by every thread reading it.
+   */
+  class PackedReader {
+  public:
+    /**
+     * @brief Maps a packed file
+     * @throws std::runtime_error if the file cannot be mapped or its header or size is wrong
+     */
+    explicit PackedReader(const std::string& path);
+    ~PackedReader();
+
+    PackedReader(const PackedReader&) = delete;
+    auto operator=(const PackedReader&) -> PackedReader& = delete;
+
+    // Number of records
+    auto size() const -> size_t { return count; }
+
+    auto record(size_t index) const -> std::span<const std::uint8_t, PACKED_RECORD_SIZE> {
+      return std::span<const std::uint8_t, PACKED_RECORD_SIZE>(
+          data + PACKED_HEADER_SIZE + (index * PACKED_RECORD_SIZE), PACKED_RECORD_SIZE);
+    }
+
+    /**
+     * @brief Decodes a record
+     * @throws std::runtime_error for a record that is not a board, like other damage to the file
+     */
+    auto board(size_t index) const -> Board;
+
+  private:
+    size_t length = 0;  // set while mapping, so declared before data
+    const std::uint8_t* data = nullptr;
+    size_t count = 0;
+  };
+
+  /**
+   * @brief Appends boards to a packed file
+   *
+   * Records are buffered through stdio since the final count is only known at close(), which
+   * then fills it into the header.
+   */
+  class PackedWriter {
+  public:
+    /**
+     * @brief Creates or truncates a packed file
+     * @throws std::runtime_error if the file cannot be opened or written
+     */
+    explicit PackedWriter(const std::string& path);
+    ~PackedWriter();
+
+    PackedWriter(const PackedWriter&) = delete;
+    auto operator=(const PackedWriter&) -> PackedWriter& = delete;
+
+    // Appends a record, throws std::runtime_error if writing failed
+    void write(const Board& board);
+
+    // Number of records written so far
+    auto size() const -> size_t { return count; }
+
+    /**
+     * @brief Writes the header and closes the file, also done by the destructor
+     * @throws std::runtime_error if writing failed
+     */
+    void close();
+
+  private:
+    std::string path;
+    std::FILE* file;
+    size_t count = 0;
+  };
+
+  /**
+   * @brief Converts a text file of puzzles, as read by PuzzleReader, to the packed format
+   * @return the number of puzzles
+   * @throws std::runtime_error naming the line of a puzzle that does not parse
+   */
+  auto packTextFile(const std::string& textPath, const std::string& packedPath) -> size_t;
+
+  /**
+   * @brief Converts a packed file to text, one puzzle per line with '.' for blanks
+   * @return the number of puzzles
+   */
+  auto unpackToText(const std::string& packedPath, const std::string& textPath) -> size_t;
+
+}  // namespace sudoku
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <sudoku/board.h>
+#include <sudoku/trace.h>
+
+#include <cstddef>
+
+namespace sudoku {
+
+  /**
+   * @brief Work counters of the propagation engine
+   *
+   * The old penciling rule swept all 81 cells and their three units until nothing changed.
+   * sweepVisits() is what a single such sweep per run would cost on a 9x9 board, comparing it
+   * with peerVisits shows how much work the queue saves.
+   */
+  struct PropagationStats {
+    size_t runs = 0;          // calls of propagate()
+    size_t solvedCells = 0;   // cells taken off the work queue
+    size_t peerVisits = 0;    // peer cells examined
+    size_t eliminations = 0;  // candidates removed
+
+    auto sweepVisits() const -> size_t { return runs * CELLS * PEERS; }
+  };
+
+  /**
+   * @brief Remove the digit of every queued solved cell from its peers
+   * @details Peers solved on the way are queued and handled in the same call, so the board is
+   * fully penciled on return.
+   * @param tracer receives an event per elimination and placement if given
+   * @return true if any candidate was removed
+   */
+  template <size_t BOX>
+  auto propagate(BasicBoard<BOX>& board, PropagationStats& stats, const Tracer* tracer = nullptr)
+      -> bool;
+
+  extern template auto propagate(BasicBoard<2>&, PropagationStats&, const Tracer*) -> bool;
+  extern template auto propagate(BasicBoard<3>&, PropagationStats&, const Tracer*) -> bool;
+  extern template auto propagate(BasicBoard<4>&, PropagationStats&, const Tracer*) -> bool;
+  extern template auto propagate(BasicBoard<5>&, PropagationStats&, const Tracer*) -> bool;
+
+}  // namespace sudoku
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace sudoku {
+
+  /**
+   * @brief Streams puzzles from a text file, one per line
+   *
+   * The file is read in fixed chunks into one buffer and lines are handed out as views into it,
+   * so no string is built per line. Blank lines and lines starting with '#' are skipped, trailing
+   * whitespace (including '\r') is trimmed.
+   */
+  class PuzzleReader {
+  public:
+    static constexpr size_t DEFAULT_CHUNK_SIZE = size_t{1} << 20;
+
+    /**
+     * @brief Opens a puzzle file
+     * @throws std::runtime_error if the file cannot be opened
+     */
+    explicit PuzzleReader(const std::string& path, size_t chunkSize = DEFAULT_CHUNK_SIZE);
+    ~PuzzleReader();
+
+    PuzzleReader(const PuzzleReader&) = delete;
+    auto operator=(const PuzzleReader&) -> PuzzleReader& = delete;
+
+    /**
+     * @brief Reads the next puzzle
+     * @return a view valid until the next call, or nothing at the end of the file
+     */
+    auto next() -> std::optional<std::string_view>;
+
+    // Line number of the last puzzle returned by next(), starting at 1
+    auto lineNumber() const -> size_t { return line; }
+
+  private:
+    std::FILE* file;
+    std::vector<char> buffer;
+    size_t chunkSize;
+    size_t begin = 0;
+    size_t end = 0;
+    size_t line = 0;
+    bool eof = false;
+
+    auto fill() -> bool;
+  };
+
+}  // namespace sudoku
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <sudoku/trace.h>
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <string>
+
+namespace sudoku {
+
+  /**
+   * @brief Work done by one rule
+   *
+   * Search counts a node per invocation and a guess per firing. Its time covers the whole search,
+   * including the rules run inside it, which also count as usual.
+   */
+  struct RuleStats {
+    size_t invoked = 0;     // times the rule was tried
+    size_t fired = 0;       // times it changed the board
+    size_t eliminated = 0;  // candidates it removed
+    std::chrono::nanoseconds time{0};
+
+    auto operator+=(const RuleStats& other) -> RuleStats& {
+      invoked += other.invoked;
+      fired += other.fired;
+      eliminated += other.eliminated;
+      time += other.time;
+      return *this;
+    }
+  };
+
+  /**
+   * @brief Per rule counters of a Sudoku, summed over puzzles in batch mode
+   */
+  struct SolveStats {
+    std::array<RuleStats, RULES> rules{};
+    size_t puzzles = 0;
+
+    auto operator[](Rule rule) -> RuleStats& { return rules[static_cast<size_t>(rule)]; }
+    auto operator[](Rule rule) const -> const RuleStats& {
+      return rules[static_cast<size_t>(rule)];
+    }
+
+    auto operator+=(const SolveStats& other) -> SolveStats& {
+      for (size_t i = 0; i < RULES; i++) {
+        rules[i] += other.rules[i];
+      }
+      puzzles += other.puzzles;
+      return *this;
+    }
+  };
+
+  /**
+   * @brief Formats stats as an aligned table, one rule per line
+   */
+  auto statsToText(const SolveStats& stats) -> std::string;
+
+  /**
+   * @brief Formats stats as a JSON object, times in microseconds
+   */
+  auto statsToJson(const SolveStats& stats) -> std::string;
+
+}  // namespace sudoku
@@ -1,214 +1,194 @@
 #pragma once
 
+#include <sudoku/board.h>
+#include <sudoku/propagation.h>
+#include <sudoku/stats.h>
+#include <sudoku/trace.h>
+
 #include <array>
-#include <bitset>
 #include <iostream>
-#include <optional>
+#include <span>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace sudoku {
 
-  const size_t ROWS = 9;
-  const size_t COLS = 9;
-
-  using Candidates = std::bitset<9>;
-
-  struct Cell {
-    size_t row;
-    size_t col;
-    Candidates candidates;
-
-    // Default for Board initialization, note row and col are 0
-    Cell() : row(0), col(0), candidates{} { candidates.set(); }
-
-    // Construct with no candidates given (set all)
-    Cell(size_t r, size_t c) : row(r), col(c), candidates{} { candidates.set(); }
-
-    // Construct with given candidates
-    Cell(size_t r, size_t c, Candidates candidates) : row(r), col(c), candidates(candidates) {}
-
-    // Add a candidate (digit 1–9)
-    void addCandidate(int digit) { candidates.set(digit - 1); }
-
-    // Remove a candidate
-    void removeCandidate(int digit) { candidates.reset(digit - 1); }
-
-    // Check if a candidate is present
-    bool hasCandidate(int digit) const { return candidates.test(digit - 1); }
-
-    // Get number of candidates
-    int candidateCount() const { return candidates.count(); }
-
-    // Return all candidates as a vector of ints
-    std::vector<int> toVector() const {
-      std::vector<int> result;
-      for (int i = 0; i < 9; ++i) {
-        if (candidates.test(i)) {
-          result.push_back(i + 1);
-        }
-      }
-      return result;
-    }
-
-    // Keep only a specific set of digits
-    void keepOnly(const std::vector<int>& digits) {
-      Candidates newCandidates;
-    for (int d : digits) {
-        if (candidates.test(d - 1)) {
-            newCandidates.set(d - 1);
-        }
-    }
-    candidates = newCandidates;
-    }
-    void keepOnly(int digit) {
-      Candidates newCandidates;
-        if (candidates.test(digit - 1)) {
-            newCandidates.set(digit - 1);
-        }
-    candidates = newCandidates;
-    }
-
+  /**
+   * @brief Whether a Sudoku keeps the changes of every step so it can rewind
+   */
+  enum class History {
+    Keep,  // log every candidate removal, see Sudoku::rewind()
+    None   // keep only the current board
   };
 
-  struct Group {
-    std::vector<Cell*> cells;
-
-    // Add a cell reference
-    void add(Cell& cell) { cells.push_back(&cell); }
-
-    // iteration
-    struct iterator {
-      using base_iter = std::vector<Cell*>::iterator;
-      base_iter it;
-      iterator(base_iter i) : it(i) {}
-      Cell& operator*() const { return **it; }
-      iterator& operator++() {
-        ++it;
-        return *this;
-      }
-      bool operator!=(const iterator& other) const { return it != other.it; }
-    };
-
-    auto begin() { return iterator(cells.begin()); }
-    auto end() { return iterator(cells.end()); }
-
-    // const iteration
-    struct const_iterator {
-      using base_iter = std::vector<Cell*>::const_iterator;
-      base_iter it;
-      const_iterator(base_iter i) : it(i) {}
-      const Cell& operator*() const { return **it; }
-      const_iterator& operator++() {
-        ++it;
-        return *this;
-      }
-      bool operator!=(const const_iterator& other) const { return it != other.it; }
-    };
-
-    auto begin() const { return const_iterator(cells.begin()); }
-    auto end() const { return const_iterator(cells.end()); }
-
-    // size function
-    size_t size() const { return cells.size(); }
-
-    // operator[] returns reference
-    Cell& operator[](size_t i) { return *cells[i]; }
-    const Cell& operator[](size_t i) const { return *cells[i]; }
+  /**
+   * @brief How far Sudoku::solve() goes
+   */
+  enum class SolveMode {
+    Logic,           // apply the logical rules until none fires
+    LogicThenSearch  // then branch on the cell with fewest candidates, using the rules to propagate
   };
 
-  struct Board {
-    std::array<std::array<Cell, 9>, 9> cells;
-
-    Board() : cells{} {
-      cells = {};
-      for (size_t i = 0; i < ROWS; i++) {
-        for (size_t j = 0; j < COLS; j++) {
-          cells[i][j].row = i;
-          cells[i][j].col = j;
-        }
-      }
-    }
-
-    auto getCell(size_t row, size_t col) -> Cell& { return cells[row][col]; }
-    auto getCell(size_t row, size_t col) const -> const Cell& { return cells[row][col]; }
+  /**
+   * @brief How much of the board a rule works through per step
+   */
+  enum class Sweep {
+    First,  // stop at the first unit or digit a rule changes, one finding per step to explain
+    All     // apply every finding of a rule in one pass before the next rule runs
+  };
 
-    auto getRow(size_t row) -> Group {
-      Group rowCells;
-      for (size_t col = 0; col < COLS; ++col) {
-        rowCells.add(cells[row][col]);
-      }
-      return rowCells;
-    }
+  // Every logical rule, cheapest first, the default pipeline
+  inline constexpr std::array<Rule, 6> LOGIC_RULES
+      = {Rule::Penciling, Rule::HiddenSingles, Rule::Pointing,
+         Rule::NakedSubsets, Rule::HiddenSubsets, Rule::Fish};
 
-    auto getCol(size_t col) -> Group {
-      Group colCells;
-      for (size_t row = 0; row < ROWS; ++row) {
-        colCells.add(cells[row][col]);
-      }
-      return colCells;
-    }
+  // Only the rules placing digits, for solving with search when explanations do not matter
+  inline constexpr std::array<Rule, 2> SINGLES_RULES = {Rule::Penciling, Rule::HiddenSingles};
 
-    auto getBlock(size_t row, size_t col) -> Group {
-      Group blockCells;
-      size_t r0 = (row / 3) * 3;
-      size_t c0 = (col / 3) * 3;
-      for (size_t dr = 0; dr < 3; ++dr) {
-        for (size_t dc = 0; dc < 3; ++dc) {
-          blockCells.add(cells[r0 + dr][c0 + dc]);
-        }
-      }
-      return blockCells;
-    }
-  };
+  /**
+   * @brief Parses a rule pipeline
+   * @param spec "all", "singles" or a comma separated list of rule names, case and spaces or
+   * dashes ignored, e.g. "penciling,hidden-singles,fish"
+   * @throws std::invalid_argument for unknown or repeated rules and for search
+   */
+  auto parseRules(std::string_view spec) -> std::vector<Rule>;
 
   /**
    * @brief A class for saying hello in multiple languages
+   *
+   * The board and every rule are specialized at compile time for boxes of BOX x BOX cells,
+   * Sudoku is the classic 9x9 game.
    */
-  class Sudoku {
+  template <size_t BOX> class BasicSudoku {
+  public:
+    using Geometry = sudoku::Geometry<BOX>;
+    using Board = BasicBoard<BOX>;
+    using Candidates = typename Geometry::Candidates;
+
+    static constexpr size_t SIZE = Geometry::SIZE;
+
   private:
-    std::vector<Board> state;
+    using CellIndex = typename Geometry::CellIndex;
+    using Unit = typename Geometry::Unit;
+    using Segment = typename Geometry::Segment;
+    using ChangeLog = typename Board::ChangeLog;
+
+    static constexpr size_t ROWS = SIZE;
+    static constexpr size_t COLS = SIZE;
+    static constexpr size_t CELLS = Geometry::CELLS;
+    static constexpr size_t UNITS = Geometry::UNITS;
+    static constexpr size_t UNIT_SIZE = Geometry::UNIT_SIZE;
+    static constexpr Candidates ALL_CANDIDATES = Geometry::ALL_CANDIDATES;
+
+    Board board;
+    ChangeLog changes;
+    std::vector<size_t> stepMarks;  // size of changes once every snapshot was taken
+    size_t steps = 1;
+    bool keepHistory;
+    PropagationStats propagationStats;
+    SolveStats solveStats;
+    Tracer tracer;
+    std::vector<Rule> pipeline{LOGIC_RULES.begin(), LOGIC_RULES.end()};
+    Sweep sweep = Sweep::First;
+    // Bumped on every board change, a rule that found nothing at the current version is skipped
+    size_t boardVersion = 1;
+    std::array<size_t, RULES> idleVersion{};
+    bool timeRules = true;  // off where the clock would cost more than the rules
+
+    // Board updates made by rules, reported to the tracer
+    auto eliminate(Rule rule, size_t cell, Candidates mask) -> bool;
+    auto keepOnly(Rule rule, size_t cell, Candidates mask) -> bool;
 
     auto solveRulePenciling() -> bool;
-    auto solveRulePencilingCell(Cell& cell) -> bool;
-    auto solveRulePencilingCellWithGroup(Cell& cell, const Group& group) -> bool;
 
-    auto solveRulePointingGroups(Group group0, Group group1) -> bool;
-    auto solveRulePointing() -> bool;
+    auto solveRuleHiddenSinglesUnit(size_t unit) -> bool;
+    auto solveRuleHiddenSingles() -> bool;
 
-    auto solveRuleHiddenPairsGroup(Group cellGroup) -> bool;
-    auto solveRuleHiddenPairs() -> bool;
+    auto solveRulePointingSegment(const Segment& segment) -> bool;
+    auto solveRulePointing() -> bool;
 
-    auto solveRuleHiddenTuplesGroup(Group cellGroup) -> bool;
-    auto solveRuleHiddenTuples() -> bool;
+    auto solveRuleHiddenSubsetsUnit(size_t unit) -> bool;
+    auto solveRuleHiddenSubsets() -> bool;
 
-    auto solveRuleNakedPairs() -> bool;
+    auto solveRuleNakedSubsetsUnit(size_t unit) -> bool;
+    auto solveRuleNakedSubsets() -> bool;
 
-    auto solveRuleNakedTriples() -> bool;
+    auto solveRuleFishDigit(int digit) -> bool;
+    auto solveRuleFish() -> bool;
 
-    auto solveRuleXWingCells(size_t row0, size_t row1, size_t col0, size_t col1) -> bool;
-    auto solveRuleXWing() -> bool;
+    void beginStep();
+    void endStep();
+    auto applyRules() -> bool;
+    auto findBranchCell() const -> size_t;
+    auto searchNode() -> bool;
+    void countNode(size_t limit, std::span<Board> solutions, size_t& found);
 
     static auto convertRCtoI(size_t row, size_t col) -> size_t;
 
-    auto getCell(size_t row, size_t col) -> Cell&;
-    auto getCell(size_t row, size_t col) const -> const Cell&;
-    auto getRow(size_t row) -> Group;
-    auto getCol(size_t col) -> Group;
-    auto getBlock(size_t row, size_t col) -> Group;
+    auto getCell(size_t row, size_t col) const -> Candidates;
 
   public:
     /**
      * @brief Creates a new sudoku
-     * @param name the name to greet
+     * @param initial_state_str one character per cell, see parseBoard()
+     * @param history whether to log changes for rewind()
+     */
+    explicit BasicSudoku(std::string_view initial_state_str, History history = History::Keep);
+
+    // Creates a sudoku from a board parsed beforehand, e.g. with tryParseBoard()
+    explicit BasicSudoku(const Board& initial, History history = History::Keep);
+
+    /**
+     * @brief Replaces the sudoku, reusing the memory of the current one
+     * @param initial_state_str one character per cell, see parseBoard()
      */
-    explicit Sudoku(std::string initial_state_str);
+    void load(std::string_view initial_state_str);
+
+    void load(const Board& initial);
 
     // Return number of snapshots (steps taken)
     auto stepsTaken() const -> size_t;
 
+    /**
+     * @brief Returns to the board as it was at a snapshot, 0 being the initial board
+     * @throws std::out_of_range without history or for a step not taken yet
+     */
+    void rewind(size_t step);
+
+    /**
+     * @brief Receive an event for every candidate the solver removes, see TraceEvent
+     * @details Pass an empty sink to stop tracing.
+     */
+    void setTraceSink(TraceSink sink);
+
+    /**
+     * @brief Chooses the logical rules and the order they are tried in
+     * @details Every step tries the rules in order and stops at the first that fires, so the
+     * next step starts over at the first, cheapest rule. Without Rule::Penciling solved cells
+     * are not cleared from their peers, which only search and the other rules can make up for.
+     * @throws std::invalid_argument for repeated rules and for Rule::Search
+     */
+    void setRules(std::span<const Rule> rules);
+
+    auto getRules() const -> std::span<const Rule>;
+
+    /**
+     * @brief Chooses between explainable steps and fewer rule passes, Sweep::First by default
+     * @details Penciling and pointing always apply everything they find.
+     */
+    void setSweep(Sweep mode);
+
+    auto getSweep() const -> Sweep;
+
     auto solved() const -> bool;
 
+    // Work done by the penciling rule's propagation engine so far
+    auto getPropagationStats() const -> const PropagationStats&;
+
+    // Invocations, firings, eliminations and time of every rule since construction or load()
+    auto getSolveStats() const -> const SolveStats&;
+
     /**
      * @brief Creates a table
      * @return a string containing the greeting
@@ -223,10 +203,46 @@ namespace sudoku {
      */
     auto toString() const -> std::string;
 
+    /**
+     * @brief Writes the board as toString() does into a caller's buffer, without allocating
+     * @return the number of characters written, or 0 if the buffer is too small
+     */
+    auto writeString(std::span<char> buffer) const noexcept -> size_t;
+
+    // The current board, for formatBoard() and formatTable() into any output iterator
+    auto getBoard() const -> const Board& { return board; }
+
     // Friend function to overload <<
-    friend std::ostream& operator<<(std::ostream& os, const Sudoku& s);
+    friend std::ostream& operator<<(std::ostream& os, const BasicSudoku& s) {
+      os << s.toString();
+      return os;
+    }
 
     bool solveStep();
+
+    /**
+     * @brief Solves the sudoku
+     * @param mode whether to fall back to search when no rule fires
+     * @return true if the sudoku is solved
+     */
+    auto solve(SolveMode mode = SolveMode::Logic) -> bool;
+
+    /**
+     * @brief Counts the solutions of the current board, leaving it unchanged
+     * @details Searches as solve(SolveMode::LogicThenSearch) does, on a copy of the game with
+     * penciling and hidden singles as rules whatever setRules() chose, and stops once limit
+     * solutions are found, so 2 tells unique puzzles from the rest.
+     * @param solutions receives the first solutions found, as many as fit
+     * @return the number of solutions found, at most limit
+     */
+    auto countSolutions(size_t limit = 2, std::span<Board> solutions = {}) const -> size_t;
   };
 
+  extern template class BasicSudoku<2>;
+  extern template class BasicSudoku<3>;
+  extern template class BasicSudoku<4>;
+  extern template class BasicSudoku<5>;
+
+  using Sudoku = BasicSudoku<3>;
+
 }  // namespace sudoku
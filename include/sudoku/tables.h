@@ -0,0 +1,200 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace sudoku {
+
+  /**
+   * @brief Sizes, index types and constant tables of a board made of BOX x BOX boxes
+   *
+   * A board has BOX * BOX rows, columns, boxes and digits, so Geometry<3> is the classic 9x9
+   * sudoku, Geometry<4> a 16x16 Hexadoku. Everything is resolved at compile time and index and
+   * mask types are the narrowest that fit.
+   *
+   * Units 0 to SIZE - 1 are rows, then come the columns and the boxes. Segments, the cells shared
+   * by a box and a row or column, list the box/row intersections first.
+   */
+  template <size_t BOX> struct Geometry {
+    static_assert(BOX >= 2 && BOX <= 5, "Boards from 4x4 to 25x25 are supported");
+
+    static constexpr size_t BOX_SIZE = BOX;
+    static constexpr size_t SIZE = BOX * BOX;  // rows, columns, boxes and digits
+    static constexpr size_t CELLS = SIZE * SIZE;
+    static constexpr size_t UNITS = 3 * SIZE;
+    static constexpr size_t UNIT_SIZE = SIZE;
+    static constexpr size_t PEERS = (3 * SIZE) - (2 * BOX) - 1;
+    static constexpr size_t SEGMENT_SIZE = BOX;
+    static constexpr size_t SEGMENTS = 2 * SIZE * BOX;
+
+    // Cell indices are row-major
+    using CellIndex = std::conditional_t<(CELLS <= 256), std::uint8_t, std::uint16_t>;
+
+    // One bit per digit, bit 0 holds digit 1
+    using Candidates = std::conditional_t<(SIZE <= 16), std::uint16_t, std::uint32_t>;
+
+    static constexpr Candidates ALL_CANDIDATES = static_cast<Candidates>((1ULL << SIZE) - 1);
+
+    // The cells of a row, column or box
+    using Unit = std::array<CellIndex, UNIT_SIZE>;
+
+    /**
+     * @brief Cells shared by a box and a row or column
+     *
+     * lineRest and boxRest are the cells of the line and of the box outside the segment.
+     */
+    struct Segment {
+      std::uint8_t box;
+      std::uint8_t line;  // unit index of the row or column
+      std::array<CellIndex, SEGMENT_SIZE> cells;
+      std::array<CellIndex, UNIT_SIZE - SEGMENT_SIZE> lineRest;
+      std::array<CellIndex, UNIT_SIZE - SEGMENT_SIZE> boxRest;
+    };
+
+    static constexpr auto rowUnit(size_t row) -> size_t { return row; }
+    static constexpr auto colUnit(size_t col) -> size_t { return SIZE + col; }
+    static constexpr auto boxUnit(size_t box) -> size_t { return (2 * SIZE) + box; }
+    static constexpr auto boxOf(size_t row, size_t col) -> size_t {
+      return ((row / BOX) * BOX) + (col / BOX);
+    }
+
+    static constexpr auto makeUnits() -> std::array<Unit, UNITS> {
+      std::array<Unit, UNITS> units{};
+      for (size_t i = 0; i < SIZE; i++) {
+        for (size_t j = 0; j < SIZE; j++) {
+          units[rowUnit(i)][j] = static_cast<CellIndex>((i * SIZE) + j);
+          units[colUnit(i)][j] = static_cast<CellIndex>((j * SIZE) + i);
+          size_t row = ((i / BOX) * BOX) + (j / BOX);
+          size_t col = ((i % BOX) * BOX) + (j % BOX);
+          units[boxUnit(i)][j] = static_cast<CellIndex>((row * SIZE) + col);
+        }
+      }
+      return units;
+    }
+
+    static constexpr auto makeCellUnits() -> std::array<std::array<std::uint8_t, 3>, CELLS> {
+      std::array<std::array<std::uint8_t, 3>, CELLS> cellUnits{};
+      for (size_t cell = 0; cell < CELLS; cell++) {
+        size_t row = cell / SIZE;
+        size_t col = cell % SIZE;
+        cellUnits[cell] = {static_cast<std::uint8_t>(rowUnit(row)),
+                           static_cast<std::uint8_t>(colUnit(col)),
+                           static_cast<std::uint8_t>(boxUnit(boxOf(row, col)))};
+      }
+      return cellUnits;
+    }
+
+    static constexpr auto makePeers() -> std::array<std::array<CellIndex, PEERS>, CELLS> {
+      std::array<std::array<CellIndex, PEERS>, CELLS> peers{};
+      for (size_t cell = 0; cell < CELLS; cell++) {
+        size_t row = cell / SIZE;
+        size_t col = cell % SIZE;
+        size_t count = 0;
+        for (size_t other = 0; other < CELLS; other++) {
+          size_t otherRow = other / SIZE;
+          size_t otherCol = other % SIZE;
+          if (other != cell
+              && (otherRow == row || otherCol == col
+                  || boxOf(otherRow, otherCol) == boxOf(row, col))) {
+            peers[cell][count++] = static_cast<CellIndex>(other);
+          }
+        }
+      }
+      return peers;
+    }
+
+    static constexpr auto makeSegments() -> std::array<Segment, SEGMENTS> {
+      auto units = makeUnits();
+      std::array<Segment, SEGMENTS> segments{};
+      size_t count = 0;
+      for (size_t lineKind = 0; lineKind < 2; lineKind++) {
+        for (size_t line = 0; line < SIZE; line++) {
+          for (size_t part = 0; part < BOX; part++) {
+            Segment& segment = segments[count++];
+            size_t lineUnit = lineKind == 0 ? rowUnit(line) : colUnit(line);
+            size_t box = lineKind == 0 ? boxOf(line, part * BOX) : boxOf(part * BOX, line);
+            segment.box = static_cast<std::uint8_t>(box);
+            segment.line = static_cast<std::uint8_t>(lineUnit);
+            for (size_t k = 0; k < SEGMENT_SIZE; k++) {
+              segment.cells[k] = units[lineUnit][(part * BOX) + k];
+            }
+            auto inSegment = [&segment](CellIndex cell) {
+              for (auto own : segment.cells) {
+                if (own == cell) {
+                  return true;
+                }
+              }
+              return false;
+            };
+            size_t lineCount = 0;
+            size_t boxCount = 0;
+            for (size_t k = 0; k < UNIT_SIZE; k++) {
+              if (!inSegment(units[lineUnit][k])) {
+                segment.lineRest[lineCount++] = units[lineUnit][k];
+              }
+              if (!inSegment(units[boxUnit(box)][k])) {
+                segment.boxRest[boxCount++] = units[boxUnit(box)][k];
+              }
+            }
+          }
+        }
+      }
+      return segments;
+    }
+
+    // Cells of every unit
+    static const std::array<Unit, UNITS> UNIT_CELLS;
+
+    // Row, column and box unit of every cell
+    static const std::array<std::array<std::uint8_t, 3>, CELLS> CELL_UNITS;
+
+    // The cells sharing a unit with every cell
+    static const std::array<std::array<CellIndex, PEERS>, CELLS> PEER_CELLS;
+
+    // The box/line intersections
+    static const std::array<Segment, SEGMENTS> SEGMENT_CELLS;
+  };
+
+  // Built here since a class cannot call its own constexpr functions before it is complete
+  template <size_t BOX> constexpr std::array<typename Geometry<BOX>::Unit, Geometry<BOX>::UNITS>
+      Geometry<BOX>::UNIT_CELLS = Geometry<BOX>::makeUnits();
+
+  template <size_t BOX>
+  constexpr std::array<std::array<std::uint8_t, 3>, Geometry<BOX>::CELLS> Geometry<BOX>::CELL_UNITS
+      = Geometry<BOX>::makeCellUnits();
+
+  template <size_t BOX> constexpr std::array<std::array<typename Geometry<BOX>::CellIndex,
+                                                        Geometry<BOX>::PEERS>,
+                                             Geometry<BOX>::CELLS>
+      Geometry<BOX>::PEER_CELLS = Geometry<BOX>::makePeers();
+
+  template <size_t BOX>
+  constexpr std::array<typename Geometry<BOX>::Segment, Geometry<BOX>::SEGMENTS>
+      Geometry<BOX>::SEGMENT_CELLS = Geometry<BOX>::makeSegments();
+
+  // The classic 9x9 board, which the exact cover and lane solvers are limited to
+  using Classic = Geometry<3>;
+
+  const size_t UNITS = Classic::UNITS;
+  const size_t UNIT_SIZE = Classic::UNIT_SIZE;
+  const size_t PEERS = Classic::PEERS;
+  const size_t SEGMENTS = Classic::SEGMENTS;
+  const size_t SEGMENT_SIZE = Classic::SEGMENT_SIZE;
+
+  using CellIndex = Classic::CellIndex;
+  using Unit = Classic::Unit;
+  using Segment = Classic::Segment;
+
+  inline constexpr const auto& UNIT_CELLS = Classic::UNIT_CELLS;
+  inline constexpr const auto& CELL_UNITS = Classic::CELL_UNITS;
+  inline constexpr const auto& PEER_CELLS = Classic::PEER_CELLS;
+  inline constexpr const auto& SEGMENT_CELLS = Classic::SEGMENT_CELLS;
+
+  static_assert(UNIT_CELLS[Classic::boxUnit(4)][0] == 30);
+  static_assert(PEER_CELLS[0][19] == 72);
+  static_assert(SEGMENT_CELLS[27].cells[2] == 18 && SEGMENT_CELLS[27].boxRest[0] == 1);
+  static_assert(Geometry<5>::PEER_CELLS[624].size() == 64);
+
+}  // namespace sudoku
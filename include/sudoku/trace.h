@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string_view>
+#include <utility>
+
+// Build with SUDOKU_TRACE=0 to compile every trace call out of the solver
+#ifndef SUDOKU_TRACE
+#  define SUDOKU_TRACE 1
+#endif
+
+namespace sudoku {
+
+  // The solving techniques, in the order the solver tries them
+  enum class Rule : std::uint8_t {
+    Penciling,
+    HiddenSingles,
+    Pointing,
+    NakedSubsets,
+    HiddenSubsets,
+    Fish,
+    Search
+  };
+
+  inline constexpr size_t RULES = static_cast<size_t>(Rule::Search) + 1;
+
+  constexpr auto ruleName(Rule rule) -> std::string_view {
+    switch (rule) {
+      case Rule::Penciling:
+        return "Penciling";
+      case Rule::HiddenSingles:
+        return "Hidden Singles";
+      case Rule::Pointing:
+        return "Pointing";
+      case Rule::NakedSubsets:
+        return "Naked Subsets";
+      case Rule::HiddenSubsets:
+        return "Hidden Subsets";
+      case Rule::Fish:
+        return "Fish";
+      case Rule::Search:
+        return "Search";
+    }
+    return "Unknown";
+  }
+
+  /**
+   * @brief One change made by the solver
+   *
+   * digits holds the removed candidates for Eliminated, the remaining digit for Placed and the
+   * tried digit for Guessed and Backtracked. Fields are wide enough for 25x25 boards.
+   */
+  struct TraceEvent {
+    enum class Kind : std::uint8_t { Eliminated, Placed, Guessed, Backtracked };
+
+    Kind kind;
+    Rule rule;
+    std::uint16_t cell;
+    std::uint32_t digits;
+  };
+
+  using TraceSink = std::function<void(const TraceEvent&)>;
+
+  /**
+   * @brief Hands solver events to an optional sink
+   *
+   * Events are plain values, nothing is formatted unless the sink does so. Without a sink the
+   * solver pays one branch per change, with SUDOKU_TRACE=0 not even that.
+   */
+  class Tracer {
+  public:
+    static constexpr bool ENABLED = SUDOKU_TRACE != 0;
+
+    void setSink(TraceSink newSink) { sink = std::move(newSink); }
+
+    auto active() const -> bool {
+      if constexpr (ENABLED) {
+        return static_cast<bool>(sink);
+      } else {
+        return false;
+      }
+    }
+
+    void emit(TraceEvent::Kind kind, Rule rule, size_t cell, std::uint32_t digits) const {
+      if (active()) {
+        sink({kind, rule, static_cast<std::uint16_t>(cell), digits});
+      }
+    }
+
+  private:
+    TraceSink sink;
+  };
+
+}  // namespace sudoku
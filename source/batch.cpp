@@ -0,0 +1,292 @@
+#include <fmt/format.h>
+#include <sudoku/batch.h>
+#include <sudoku/dlx.h>
+#include <sudoku/io.h>
+#include <sudoku/lanes.h>
+#include <sudoku/packed.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <utility>
+
+namespace sudoku {
+
+  namespace {
+
+    /**
+     * @brief Slice of puzzle indices owned by one worker
+     *
+     * begin and end are packed into one atomic word so the owner taking from the front and
+     * thieves cutting off the back never need a lock.
+     */
+    class WorkRange {
+    public:
+      void assign(std::uint32_t begin, std::uint32_t end) { range.store(pack(begin, end)); }
+
+      // Take the next index from the front
+      auto pop() -> std::optional<std::uint32_t> {
+        std::uint64_t current = range.load();
+        while (beginOf(current) < endOf(current)) {
+          if (range.compare_exchange_weak(current,
+                                          pack(beginOf(current) + 1, endOf(current)))) {
+            return beginOf(current);
+          }
+        }
+        return std::nullopt;
+      }
+
+      // Cut off the back half, returns its [begin, end)
+      auto steal() -> std::optional<std::pair<std::uint32_t, std::uint32_t>> {
+        std::uint64_t current = range.load();
+        while (endOf(current) - beginOf(current) > 1) {
+          std::uint32_t mid = beginOf(current) + ((endOf(current) - beginOf(current)) / 2);
+          if (range.compare_exchange_weak(current, pack(beginOf(current), mid))) {
+            return std::pair{mid, endOf(current)};
+          }
+        }
+        return std::nullopt;
+      }
+
+      auto remaining() const -> std::uint32_t {
+        std::uint64_t current = range.load();
+        return endOf(current) - beginOf(current);
+      }
+
+    private:
+      std::atomic<std::uint64_t> range{0};
+
+      static auto pack(std::uint32_t begin, std::uint32_t end) -> std::uint64_t {
+        return (std::uint64_t{begin} << 32) | end;
+      }
+      static auto beginOf(std::uint64_t packed) -> std::uint32_t {
+        return static_cast<std::uint32_t>(packed >> 32);
+      }
+      static auto endOf(std::uint64_t packed) -> std::uint32_t {
+        return static_cast<std::uint32_t>(packed);
+      }
+    };
+
+    // Solver state a worker keeps across puzzles
+    struct Worker {
+      static constexpr size_t LANE_CHUNK = 4 * LaneSolver::LANES;
+
+      std::optional<Sudoku> game;
+      std::unique_ptr<DancingLinks> links;
+      std::unique_ptr<LaneSolver> lanes;
+      std::vector<std::uint32_t> laneIndices;
+      std::vector<Board> laneBoards;
+      std::vector<Board> laneResults;
+      std::vector<LaneStatus> laneStatus;
+      SolveStats stats;
+
+      auto dancingLinks() -> DancingLinks& {
+        if (!links) {
+          links = std::make_unique<DancingLinks>();
+        }
+        return *links;
+      }
+
+      // Solve with DancingLinks, returns the board itself if it has no solution
+      auto solveExact(const Board& board, bool& solved) -> Board {
+        Board solution;
+        solved = dancingLinks().solve(board, 1, {&solution, 1}) == 1;
+        return solved ? solution : board;
+      }
+
+      // Collect a puzzle for the lane solver, returns true once a chunk is full
+      auto queueLane(std::uint32_t index, const Board& puzzle) -> bool {
+        laneBoards.push_back(puzzle);
+        laneIndices.push_back(index);
+        return laneIndices.size() == LANE_CHUNK;
+      }
+
+      // Run the collected puzzles through the lanes. Stalled ones start over from the puzzle on
+      // the worker's game rather than from the lane's board, so their results and rule counts
+      // are those of Engine::Rules, and the singles they redo are cheap next to the search.
+      // Errors go to the lane's result, the queue is empty afterwards either way.
+      void flushLanes(const BatchOptions& options, std::vector<BatchResult>& results) {
+        if (laneIndices.empty()) {
+          return;
+        }
+        if (!lanes) {
+          lanes = std::make_unique<LaneSolver>();
+        }
+        laneResults.resize(laneBoards.size());
+        laneStatus.resize(laneBoards.size());
+        lanes->solve(laneBoards, laneResults, laneStatus);
+        for (size_t i = 0; i < laneIndices.size(); i++) {
+          BatchResult& result = results[laneIndices[i]];
+          try {
+            if (laneStatus[i] == LaneStatus::Stalled) {
+              solve(laneBoards[i], options, result);
+              continue;
+            }
+            stats.puzzles++;
+            result.solved = laneStatus[i] == LaneStatus::Solved;
+            result.solution = boardToString(laneResults[i]);
+          } catch (const std::exception& e) {
+            result = BatchResult{};
+            result.error = e.what();
+          }
+        }
+        laneIndices.clear();
+        laneBoards.clear();
+      }
+
+      // The worker's game, loaded with a puzzle
+      auto load(const Board& puzzle, const BatchOptions& options) -> Sudoku& {
+        if (game) {
+          game->load(puzzle);
+        } else {
+          // Bad rules fail every puzzle instead of leaving a worker on the default ones
+          Sudoku fresh(puzzle, History::None);
+          fresh.setRules(options.rules);
+          fresh.setSweep(options.sweep);
+          game.emplace(std::move(fresh));
+        }
+        return *game;
+      }
+
+      void solve(const Board& puzzle, const BatchOptions& options, BatchResult& result) {
+        if (options.engine == Engine::DancingLinks) {
+          stats.puzzles++;
+          result.solution = boardToString(solveExact(puzzle, result.solved));
+          return;
+        }
+        Sudoku& loaded = load(puzzle, options);
+        result.solved = loaded.solve(options.mode);
+        result.solution = loaded.toString();
+        stats += loaded.getSolveStats();
+      }
+
+      void count(const Board& puzzle, const BatchOptions& options, BatchResult& result) {
+        stats.puzzles++;
+        Board first;
+        if (options.engine == Engine::DancingLinks) {
+          result.solutions = dancingLinks().solve(puzzle, options.countLimit, {&first, 1});
+        } else {
+          result.solutions = load(puzzle, options).countSolutions(options.countLimit, {&first, 1});
+        }
+        result.solved = result.solutions > 0;
+        result.solution = boardToString(result.solved ? first : puzzle);
+      }
+    };
+
+    /**
+     * @brief Solves count puzzles on a pool of workers
+     * @param load decodes puzzle i into a board, or sets the error of its result and returns false
+     */
+    template <typename Load>
+    auto runBatch(size_t count, const BatchOptions& options, SolveStats* stats, const Load& load)
+        -> std::vector<BatchResult> {
+      std::vector<BatchResult> results(count);
+      if (count == 0) {
+        return results;
+      }
+
+      size_t threads = options.threads != 0 ? options.threads
+                                            : std::max(1U, std::thread::hardware_concurrency());
+      threads = std::min(threads, count);
+
+      std::vector<WorkRange> ranges(threads);
+      for (size_t i = 0; i < threads; i++) {
+        ranges[i].assign(static_cast<std::uint32_t>(count * i / threads),
+                         static_cast<std::uint32_t>(count * (i + 1) / threads));
+      }
+
+      std::vector<SolveStats> workerStats(threads);
+      auto work = [&](size_t self) {
+        Worker worker;
+        Board puzzle;
+        while (true) {
+          while (auto index = ranges[self].pop()) {
+            BatchResult& result = results[*index];
+            try {
+              if (!load(*index, puzzle, result)) {
+                continue;
+              }
+              if (options.countLimit != 0) {
+                worker.count(puzzle, options, result);
+              } else if (options.engine != Engine::Lanes) {
+                worker.solve(puzzle, options, result);
+              } else if (worker.queueLane(*index, puzzle)) {
+                worker.flushLanes(options, results);
+              }
+            } catch (const std::exception& e) {
+              result = BatchResult{};
+              result.error = e.what();
+            }
+          }
+
+          // Steal from the worker with the most work left
+          size_t victim = self;
+          std::uint32_t most = 1;
+          for (size_t i = 0; i < threads; i++) {
+            if (ranges[i].remaining() > most) {
+              victim = i;
+              most = ranges[i].remaining();
+            }
+          }
+          if (victim == self) {
+            // Single leftover puzzles are picked up by their owners
+            worker.flushLanes(options, results);
+            workerStats[self] = worker.stats;
+            return;
+          }
+          if (auto stolen = ranges[victim].steal()) {
+            ranges[self].assign(stolen->first, stolen->second);
+          }
+        }
+      };
+
+      std::vector<std::jthread> pool;
+      pool.reserve(threads - 1);
+      for (size_t i = 1; i < threads; i++) {
+        pool.emplace_back(work, i);
+      }
+      work(0);
+      pool.clear();
+
+      if (stats != nullptr) {
+        for (const auto& threadStats : workerStats) {
+          *stats += threadStats;
+        }
+      }
+
+      return results;
+    }
+
+  }  // namespace
+
+  auto solveBatch(std::span<const std::string_view> puzzles, const BatchOptions& options,
+                  SolveStats* stats) -> std::vector<BatchResult> {
+    // Parsed without throwing, a bad puzzle only sets the error of its result
+    auto parse = [puzzles](size_t index, Board& board, BatchResult& result) {
+      ParseResult parsed = tryParseBoard(puzzles[index], board);
+      if (!parsed.ok()) {
+        result.error = parseErrorMessage(parsed);
+      }
+      return parsed.ok();
+    };
+    return runBatch(puzzles.size(), options, stats, parse);
+  }
+
+  auto solveBatch(const PackedReader& corpus, size_t first, size_t count,
+                  const BatchOptions& options, SolveStats* stats) -> std::vector<BatchResult> {
+    count = std::min(count, corpus.size() - std::min(first, corpus.size()));
+    auto unpack = [&corpus, first](size_t index, Board& board, BatchResult& result) {
+      bool valid = tryUnpackBoard(corpus.record(first + index), board);
+      if (!valid) {
+        result.error = fmt::format("Packed record {} is not a sudoku", first + index);
+      }
+      return valid;
+    };
+    return runBatch(count, options, stats, unpack);
+  }
+
+}  // namespace sudoku
@@ -0,0 +1,176 @@
+#include <sudoku/dlx.h>
+
+namespace sudoku {
+
+  DancingLinks::DancingLinks() {
+    // Header row, node 0 is the root and nodes 1–324 the column headers
+    for (size_t col = 0; col <= COLUMNS; col++) {
+      left[col] = static_cast<Node>(col == 0 ? COLUMNS : col - 1);
+      right[col] = static_cast<Node>(col == COLUMNS ? 0 : col + 1);
+      up[col] = static_cast<Node>(col);
+      down[col] = static_cast<Node>(col);
+      column[col] = static_cast<Node>(col);
+      size[col] = 0;
+    }
+
+    Node next = COLUMNS + 1;
+    for (size_t cell = 0; cell < CELLS; cell++) {
+      size_t row = Board::rowOf(cell);
+      size_t col = Board::colOf(cell);
+      size_t box = Board::boxOf(cell);
+      for (size_t digit = 0; digit < 9; digit++) {
+        size_t id = (cell * 9) + digit;
+        std::array<size_t, 4> columns
+            = {1 + cell, 1 + CELLS + (row * 9) + digit, 1 + (2 * CELLS) + (col * 9) + digit,
+               1 + (3 * CELLS) + (box * 9) + digit};
+        firstNode[id] = next;
+        for (size_t k = 0; k < columns.size(); k++) {
+          Node node = next++;
+          auto header = static_cast<Node>(columns[k]);
+          column[node] = header;
+          placement[node] = static_cast<Node>(id);
+          // Append to the bottom of the column
+          up[node] = up[header];
+          down[node] = header;
+          down[up[header]] = node;
+          up[header] = node;
+          size[header]++;
+          // Link into the placement's circular row
+          left[node] = static_cast<Node>(k == 0 ? node + 3 : node - 1);
+          right[node] = static_cast<Node>(k == 3 ? node - 3 : node + 1);
+        }
+      }
+    }
+  }
+
+  void DancingLinks::cover(Node col) {
+    right[left[col]] = right[col];
+    left[right[col]] = left[col];
+    for (Node i = down[col]; i != col; i = down[i]) {
+      for (Node j = right[i]; j != i; j = right[j]) {
+        down[up[j]] = down[j];
+        up[down[j]] = up[j];
+        size[column[j]]--;
+      }
+    }
+  }
+
+  void DancingLinks::uncover(Node col) {
+    for (Node i = up[col]; i != col; i = up[i]) {
+      for (Node j = left[i]; j != i; j = left[j]) {
+        size[column[j]]++;
+        down[up[j]] = j;
+        up[down[j]] = j;
+      }
+    }
+    right[left[col]] = col;
+    left[right[col]] = col;
+  }
+
+  void DancingLinks::record() {
+    if (found < solutions.size()) {
+      Board& solution = solutions[found];
+      solution = Board{};
+      for (size_t i = 0; i < depth; i++) {
+        solution.keepOnly(chosen[i] / 9, digitMask(static_cast<int>(chosen[i] % 9) + 1));
+      }
+    }
+    found++;
+  }
+
+  void DancingLinks::search() {
+    if (right[0] == 0) {
+      record();
+      return;
+    }
+
+    // Branch on the column with the fewest remaining placements
+    Node col = right[0];
+    for (Node c = right[col]; c != 0; c = right[c]) {
+      if (size[c] < size[col]) {
+        col = c;
+      }
+    }
+    if (size[col] == 0) {
+      return;
+    }
+
+    cover(col);
+    for (Node r = down[col]; r != col && found < limit; r = down[r]) {
+      if (!allowed[placement[r]]) {
+        continue;
+      }
+      chosen[depth++] = placement[r];
+      for (Node j = right[r]; j != r; j = right[j]) {
+        cover(column[j]);
+      }
+      search();
+      for (Node j = left[r]; j != r; j = left[j]) {
+        uncover(column[j]);
+      }
+      depth--;
+    }
+    uncover(col);
+  }
+
+  auto DancingLinks::solve(const Board& puzzle, size_t limit, std::span<Board> solutions)
+      -> size_t {
+    this->limit = limit;
+    this->solutions = solutions;
+    found = 0;
+    depth = 0;
+
+    for (size_t cell = 0; cell < CELLS; cell++) {
+      for (size_t digit = 0; digit < 9; digit++) {
+        allowed[(cell * 9) + digit] = hasDigit(puzzle.getCell(cell), static_cast<int>(digit) + 1);
+      }
+    }
+
+    // Cover the givens up front, a given clashing with an earlier one leaves no solution
+    size_t givens = 0;
+    bool clash = false;
+    for (size_t cell = 0; cell < CELLS && !clash; cell++) {
+      if (!puzzle.isSolved(cell)) {
+        continue;
+      }
+      size_t digit = static_cast<size_t>(firstDigit(puzzle.getCell(cell)) - 1);
+      Node first = firstNode[(cell * 9) + digit];
+      for (Node j = first;;) {
+        // A covered column has been unlinked from the header row
+        if (right[left[column[j]]] != column[j]) {
+          clash = true;
+        }
+        j = right[j];
+        if (j == first) {
+          break;
+        }
+      }
+      if (clash) {
+        break;
+      }
+      chosen[depth++] = placement[first];
+      cover(column[first]);
+      for (Node j = right[first]; j != first; j = right[j]) {
+        cover(column[j]);
+      }
+      givens++;
+    }
+
+    if (!clash && limit > 0) {
+      search();
+    }
+
+    // Restore the links in reverse order of covering
+    while (givens > 0) {
+      givens--;
+      Node first = firstNode[chosen[--depth]];
+      for (Node j = left[first]; j != first; j = left[j]) {
+        uncover(column[j]);
+      }
+      uncover(column[first]);
+    }
+
+    return found;
+  }
+
+}  // namespace sudoku
@@ -0,0 +1,246 @@
+#include <fmt/format.h>
+#include <sudoku/generator.h>
+#include <sudoku/sudoku.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cctype>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+namespace sudoku {
+
+  namespace {
+
+    // Decorrelates the seeds of neighbouring puzzles (SplitMix64)
+    auto mixSeed(std::uint64_t seed) -> std::uint64_t {
+      seed += 0x9E3779B97F4A7C15ULL;
+      seed = (seed ^ (seed >> 30)) * 0xBF58476D1CE4E5B9ULL;
+      seed = (seed ^ (seed >> 27)) * 0x94D049BB133111EBULL;
+      return seed ^ (seed >> 31);
+    }
+
+    // Fisher-Yates on the raw engine output, standard distributions differ between libraries
+    template <typename Range> void shuffle(Range& range, std::mt19937_64& random) {
+      for (size_t i = range.size() - 1; i > 0; i--) {
+        std::swap(range[i], range[random() % (i + 1)]);
+      }
+    }
+
+    auto gradeRule(std::string_view name) -> Rule {
+      auto lower = [](char c) { return std::tolower(static_cast<unsigned char>(c)); };
+      if (std::ranges::equal(name, std::string_view("search"), {}, lower)) {
+        return Rule::Search;
+      }
+      auto rules = parseRules(name);
+      if (rules.size() != 1) {
+        throw std::invalid_argument(fmt::format("'{}' is not a single rule", name));
+      }
+      return rules.front();
+    }
+
+    // Hardest rule the loaded game needs, leaves the game solved as far as the rules get
+    auto grade(Sudoku& game) -> Rule {
+      if (!game.solve()) {
+        return Rule::Search;
+      }
+      Rule hardest = Rule::Penciling;
+      for (Rule rule : LOGIC_RULES) {
+        if (game.getSolveStats()[rule].fired > 0) {
+          hardest = std::max(hardest, rule);
+        }
+      }
+      return hardest;
+    }
+
+    // Generates puzzles reusing one game for counting and grading
+    class Generator {
+    public:
+      explicit Generator(const GeneratorOptions& options) : options(options) {}
+
+      auto generate(std::uint64_t seed) -> std::optional<GeneratedPuzzle> {
+        std::mt19937_64 random(seed);
+        for (size_t attempt = 0; attempt < options.attempts; attempt++) {
+          GeneratedPuzzle generated;
+          generated.solution = fillGrid(random);
+          removeClues(generated, random);
+          if (generated.grade >= options.minGrade && generated.grade <= options.maxGrade) {
+            return generated;
+          }
+        }
+        return std::nullopt;
+      }
+
+    private:
+      GeneratorOptions options;
+      Sudoku game{Board{}, History::None};
+
+      // A random full grid: the three boxes on the diagonal are independent, the search
+      // completes the rest and relabel() shuffles the completion
+      auto fillGrid(std::mt19937_64& random) -> Board {
+        std::array<int, Classic::SIZE> digits{};
+        std::iota(digits.begin(), digits.end(), 1);
+        Board board;
+        for (size_t box = 0; box < Classic::SIZE; box += Classic::BOX_SIZE + 1) {
+          shuffle(digits, random);
+          const auto& cells = Classic::UNIT_CELLS[Classic::boxUnit(box)];
+          for (size_t i = 0; i < cells.size(); i++) {
+            board.keepOnly(cells[i], digitMask(digits[i]));
+          }
+        }
+        game.load(board);
+        Board solution;
+        game.countSolutions(1, {&solution, 1});
+        return relabel(solution, random);
+      }
+
+      // Rows or columns in random order, keeping lines of a band together
+      static auto shuffleLines(std::mt19937_64& random) -> std::array<size_t, Classic::SIZE> {
+        std::array<size_t, Classic::BOX_SIZE> bands{};
+        std::iota(bands.begin(), bands.end(), 0);
+        shuffle(bands, random);
+        std::array<size_t, Classic::SIZE> lines{};
+        for (size_t band = 0; band < Classic::BOX_SIZE; band++) {
+          std::array<size_t, Classic::BOX_SIZE> within{};
+          std::iota(within.begin(), within.end(), 0);
+          shuffle(within, random);
+          for (size_t i = 0; i < Classic::BOX_SIZE; i++) {
+            lines[(band * Classic::BOX_SIZE) + i] = (bands[band] * Classic::BOX_SIZE) + within[i];
+          }
+        }
+        return lines;
+      }
+
+      // The search completes grids in a fixed order, so its digits, rows within bands, columns
+      // within stacks, bands and stacks are permuted, which keeps a grid valid
+      static auto relabel(const Board& grid, std::mt19937_64& random) -> Board {
+        std::array<int, Classic::SIZE> digits{};
+        std::iota(digits.begin(), digits.end(), 1);
+        shuffle(digits, random);
+        auto rows = shuffleLines(random);
+        auto cols = shuffleLines(random);
+        Board relabeled;
+        for (size_t row = 0; row < Classic::SIZE; row++) {
+          for (size_t col = 0; col < Classic::SIZE; col++) {
+            int digit = firstDigit(grid.getCell(Board::index(rows[row], cols[col])));
+            relabeled.keepOnly(Board::index(row, col), digitMask(digits[digit - 1]));
+          }
+        }
+        return relabeled;
+      }
+
+      // Unique solution and no harder than the band allows
+      auto acceptable(const Board& puzzle) -> bool {
+        game.load(puzzle);
+        if (game.countSolutions(2) != 1) {
+          return false;
+        }
+        return options.maxGrade == Rule::Search || grade(game) <= options.maxGrade;
+      }
+
+      void removeClues(GeneratedPuzzle& generated, std::mt19937_64& random) {
+        std::array<std::uint8_t, CELLS> clues{};
+        for (size_t cell = 0; cell < CELLS; cell++) {
+          clues[cell] = static_cast<std::uint8_t>(firstDigit(generated.solution.getCell(cell)));
+        }
+        std::array<std::uint8_t, CELLS> order{};
+        std::iota(order.begin(), order.end(), 0);
+        shuffle(order, random);
+
+        auto boardOf = [&clues]() {
+          Board board;
+          for (size_t cell = 0; cell < CELLS; cell++) {
+            if (clues[cell] != 0) {
+              board.keepOnly(cell, digitMask(clues[cell]));
+            }
+          }
+          return board;
+        };
+
+        for (size_t cell : order) {
+          size_t mirror = options.symmetric ? CELLS - 1 - cell : cell;
+          if (clues[cell] == 0) {
+            continue;
+          }
+          auto removed = std::pair{clues[cell], clues[mirror]};
+          clues[cell] = 0;
+          clues[mirror] = 0;
+          if (!acceptable(boardOf())) {
+            clues[cell] = removed.first;
+            clues[mirror] = removed.second;
+          }
+        }
+
+        generated.puzzle = boardOf();
+        generated.clues = static_cast<size_t>(std::ranges::count_if(clues, [](auto digit) {
+          return digit != 0;
+        }));
+        game.load(generated.puzzle);
+        generated.grade = grade(game);
+      }
+    };
+
+  }  // namespace
+
+  auto gradePuzzle(const Board& puzzle) -> Rule {
+    Sudoku game(puzzle, History::None);
+    return grade(game);
+  }
+
+  auto parseGradeBand(std::string_view spec) -> std::pair<Rule, Rule> {
+    auto lower = [](char c) { return std::tolower(static_cast<unsigned char>(c)); };
+    if (std::ranges::equal(spec, std::string_view("any"), {}, lower)) {
+      return {Rule::Penciling, Rule::Search};
+    }
+    size_t colon = spec.find(':');
+    if (colon == std::string_view::npos) {
+      Rule rule = gradeRule(spec);
+      return {rule, rule};
+    }
+    auto band = std::pair{gradeRule(spec.substr(0, colon)), gradeRule(spec.substr(colon + 1))};
+    if (band.first > band.second) {
+      throw std::invalid_argument(fmt::format("Grade band '{}' is empty", spec));
+    }
+    return band;
+  }
+
+  auto generatePuzzle(std::uint64_t seed, const GeneratorOptions& options)
+      -> std::optional<GeneratedPuzzle> {
+    Generator generator(options);
+    return generator.generate(seed);
+  }
+
+  auto generatePuzzles(size_t count, const GeneratorOptions& options)
+      -> std::vector<std::optional<GeneratedPuzzle>> {
+    std::vector<std::optional<GeneratedPuzzle>> puzzles(count);
+    if (count == 0) {
+      return puzzles;
+    }
+    size_t threads = options.threads != 0 ? options.threads
+                                          : std::max(1U, std::thread::hardware_concurrency());
+    threads = std::min(threads, count);
+
+    // Puzzles take very different times, so workers take the next index as they finish
+    std::atomic<size_t> next{0};
+    auto work = [&]() {
+      Generator generator(options);
+      for (size_t index = next++; index < count; index = next++) {
+        puzzles[index] = generator.generate(mixSeed(options.seed + index));
+      }
+    };
+
+    std::vector<std::jthread> pool;
+    pool.reserve(threads - 1);
+    for (size_t i = 1; i < threads; i++) {
+      pool.emplace_back(work);
+    }
+    work();
+    pool.clear();
+    return puzzles;
+  }
+
+}  // namespace sudoku
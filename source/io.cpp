@@ -0,0 +1,157 @@
+#include <fmt/format.h>
+#include <sudoku/io.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+namespace sudoku {
+
+  namespace {
+
+    // Character classes beside the digit values 0 (blank) to 35 ('Z')
+    constexpr std::uint8_t SKIP = 0xFD;
+    constexpr std::uint8_t COMMENT = 0xFE;
+    constexpr std::uint8_t INVALID = 0xFF;
+
+    constexpr auto makeCharClasses() -> std::array<std::uint8_t, 256> {
+      std::array<std::uint8_t, 256> classes{};
+      classes.fill(INVALID);
+      classes['.'] = 0;
+      for (int digit = 0; digit <= 9; digit++) {
+        classes[static_cast<size_t>('0' + digit)] = static_cast<std::uint8_t>(digit);
+      }
+      for (int letter = 0; letter < 26; letter++) {
+        classes[static_cast<size_t>('A' + letter)] = static_cast<std::uint8_t>(10 + letter);
+        classes[static_cast<size_t>('a' + letter)] = static_cast<std::uint8_t>(10 + letter);
+      }
+      for (char c : {' ', '\t', '\r', '\n', '\v', '\f', '|', '-', '+'}) {
+        classes[static_cast<unsigned char>(c)] = SKIP;
+      }
+      classes['#'] = COMMENT;
+      return classes;
+    }
+
+    constexpr std::array<std::uint8_t, 256> CHAR_CLASSES = makeCharClasses();
+
+    // Blank or digit of a board of SIZE digits, without branches so whole lines vectorize
+    template <size_t SIZE> constexpr auto isCellChar(char c) -> bool {
+      auto digit = static_cast<unsigned char>(c - '0');
+      bool valid = (digit <= std::min<size_t>(SIZE, 9)) | (c == '.');
+      if constexpr (SIZE > 9) {
+        auto letter = static_cast<unsigned char>((c | 0x20) - 'a');
+        valid |= letter < SIZE - 9;
+      }
+      return valid;
+    }
+
+  }  // namespace
+
+  auto parseErrorMessage(const ParseResult& result, size_t cells) -> std::string {
+    switch (result.status) {
+      case ParseStatus::Ok:
+        return "";
+      case ParseStatus::TooFewCells:
+        return fmt::format("Sudoku string has {} cells, expected {}", result.cells, cells);
+      case ParseStatus::TooManyCells:
+        return fmt::format("Sudoku string has more than {} cells, '{}' at offset {}", cells,
+                           result.character, result.offset);
+      case ParseStatus::InvalidCharacter:
+        return fmt::format("Sudoku string has invalid character '{}' at offset {}",
+                           result.character, result.offset);
+    }
+    return "";
+  }
+
+  template <size_t BOX>
+  auto tryParseBoard(std::string_view text, BasicBoard<BOX>& board) noexcept -> ParseResult {
+    using Board = BasicBoard<BOX>;
+    using Candidates = typename Board::Candidates;
+    board = Board{};
+
+    // Puzzles mostly come as one line of cells, those skip the separator handling
+    size_t offset = 0;
+    size_t cells = 0;
+    if (text.size() >= Board::CELLS) {
+      bool valid = true;
+      for (size_t i = 0; i < Board::CELLS; i++) {
+        valid &= isCellChar<Board::SIZE>(text[i]);
+      }
+      if (valid) {
+        for (; cells < Board::CELLS; cells++) {
+          std::uint8_t digit = CHAR_CLASSES[static_cast<unsigned char>(text[cells])];
+          if (digit != 0) {
+            board.keepOnly(cells, digitMask<Candidates>(digit));
+          }
+        }
+        offset = Board::CELLS;
+      }
+    }
+
+    for (; offset < text.size(); offset++) {
+      std::uint8_t digit = CHAR_CLASSES[static_cast<unsigned char>(text[offset])];
+      if (digit == SKIP) {
+        continue;
+      }
+      if (digit == COMMENT) {
+        offset = std::min(text.find('\n', offset), text.size());
+        continue;
+      }
+      if (digit > Board::SIZE) {
+        return {ParseStatus::InvalidCharacter, offset, cells, text[offset]};
+      }
+      if (cells == Board::CELLS) {
+        return {ParseStatus::TooManyCells, offset, cells, text[offset]};
+      }
+      if (digit != 0) {
+        board.keepOnly(cells, digitMask<Candidates>(digit));
+      }
+      cells++;
+    }
+    if (cells < Board::CELLS) {
+      return {ParseStatus::TooFewCells, text.size(), cells, '\0'};
+    }
+    return {};
+  }
+
+  template <size_t BOX> auto parseBoard(std::string_view str) -> BasicBoard<BOX> {
+    BasicBoard<BOX> board;
+    ParseResult result = tryParseBoard(str, board);
+    if (!result.ok()) {
+      throw std::invalid_argument(parseErrorMessage(result, BasicBoard<BOX>::CELLS));
+    }
+    return board;
+  }
+
+  template <size_t BOX> auto boardToString(const BasicBoard<BOX>& board) -> std::string {
+    std::string s(BasicBoard<BOX>::CELLS, '.');
+    formatBoard(board, s.data());
+    return s;
+  }
+
+  template <size_t BOX> auto boardToTable(const BasicBoard<BOX>& board) -> std::string {
+    std::string s(TABLE_SIZE<BOX>, ' ');
+    formatTable(board, s.data());
+    return s;
+  }
+
+  template auto tryParseBoard(std::string_view, BasicBoard<2>&) noexcept -> ParseResult;
+  template auto tryParseBoard(std::string_view, BasicBoard<3>&) noexcept -> ParseResult;
+  template auto tryParseBoard(std::string_view, BasicBoard<4>&) noexcept -> ParseResult;
+  template auto tryParseBoard(std::string_view, BasicBoard<5>&) noexcept -> ParseResult;
+  template auto parseBoard<2>(std::string_view str) -> BasicBoard<2>;
+  template auto parseBoard<3>(std::string_view str) -> BasicBoard<3>;
+  template auto parseBoard<4>(std::string_view str) -> BasicBoard<4>;
+  template auto parseBoard<5>(std::string_view str) -> BasicBoard<5>;
+  template auto boardToString(const BasicBoard<2>& board) -> std::string;
+  template auto boardToString(const BasicBoard<3>& board) -> std::string;
+  template auto boardToString(const BasicBoard<4>& board) -> std::string;
+  template auto boardToString(const BasicBoard<5>& board) -> std::string;
+  template auto boardToTable(const BasicBoard<2>& board) -> std::string;
+  template auto boardToTable(const BasicBoard<3>& board) -> std::string;
+  template auto boardToTable(const BasicBoard<4>& board) -> std::string;
+  template auto boardToTable(const BasicBoard<5>& board) -> std::string;
+
+}  // namespace sudoku
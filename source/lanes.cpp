@@ -0,0 +1,113 @@
+#include <sudoku/lanes.h>
+
+#include <optional>
+
+namespace sudoku {
+
+  void LaneSolver::round(Lanes& changed, Lanes& unsolved, Lanes& invalid) {
+    changed.fill(0);
+    unsolved.fill(0);
+    invalid.fill(0);
+
+    for (const auto& unit : UNIT_CELLS) {
+      Lanes once{};
+      Lanes twice{};
+      Lanes placed{};
+      Lanes placedTwice{};
+      for (auto cell : unit) {
+        for (size_t lane = 0; lane < LANES; lane++) {
+          Candidates c = cells[cell][lane];
+          bool single = (c & (c - 1)) == 0;
+          Candidates solved = single ? c : 0;
+          twice[lane] |= once[lane] & c;
+          once[lane] |= c;
+          placedTwice[lane] |= placed[lane] & solved;
+          placed[lane] |= solved;
+          invalid[lane] |= c == 0 ? 1 : 0;
+        }
+      }
+
+      Lanes hidden{};
+      for (size_t lane = 0; lane < LANES; lane++) {
+        hidden[lane] = once[lane] & ~twice[lane] & ~placed[lane];
+        invalid[lane] |= (once[lane] != ALL_CANDIDATES || placedTwice[lane] != 0) ? 1 : 0;
+      }
+
+      for (auto cell : unit) {
+        for (size_t lane = 0; lane < LANES; lane++) {
+          Candidates c = cells[cell][lane];
+          bool single = (c & (c - 1)) == 0;
+          // Naked singles: drop digits placed elsewhere in the unit
+          Candidates reduced = single ? c : static_cast<Candidates>(c & ~placed[lane]);
+          // Hidden singles: keep the digit only this cell can hold
+          Candidates only = reduced & hidden[lane];
+          reduced = (!single && only != 0) ? only : reduced;
+          cells[cell][lane] = reduced;
+          changed[lane] |= c ^ reduced;
+          unsolved[lane] |= (reduced & (reduced - 1)) != 0 ? 1 : 0;
+        }
+      }
+    }
+  }
+
+  void LaneSolver::solve(std::span<const Board> puzzles, std::span<Board> results,
+                         std::span<LaneStatus> status) {
+    std::array<std::optional<size_t>, LANES> occupant{};
+    size_t next = 0;
+    size_t active = 0;
+
+    auto fill = [&](size_t lane) {
+      if (next < puzzles.size()) {
+        for (size_t cell = 0; cell < CELLS; cell++) {
+          cells[cell][lane] = puzzles[next].getCell(cell);
+        }
+        occupant[lane] = next++;
+        active++;
+      } else {
+        // Idle lanes hold a solved-looking board nobody reads
+        for (size_t cell = 0; cell < CELLS; cell++) {
+          cells[cell][lane] = 1;
+        }
+        occupant[lane].reset();
+      }
+    };
+
+    for (size_t lane = 0; lane < LANES; lane++) {
+      fill(lane);
+    }
+
+    Lanes changed;
+    Lanes unsolved;
+    Lanes invalid;
+    while (active > 0) {
+      round(changed, unsolved, invalid);
+      for (size_t lane = 0; lane < LANES; lane++) {
+        if (!occupant[lane]) {
+          continue;
+        }
+        std::optional<LaneStatus> finished;
+        if (invalid[lane] != 0) {
+          finished = LaneStatus::Invalid;
+        } else if (unsolved[lane] == 0) {
+          finished = LaneStatus::Solved;
+        } else if (changed[lane] == 0) {
+          finished = LaneStatus::Stalled;
+        }
+        if (!finished) {
+          continue;
+        }
+
+        size_t index = *occupant[lane];
+        Board& result = results[index];
+        result = Board{};
+        for (size_t cell = 0; cell < CELLS; cell++) {
+          result.keepOnly(cell, cells[cell][lane]);
+        }
+        status[index] = *finished;
+        active--;
+        fill(lane);
+      }
+    }
+  }
+
+}  // namespace sudoku
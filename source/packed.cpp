@@ -0,0 +1,258 @@
+#include <fmt/format.h>
+#include <sudoku/io.h>
+#include <sudoku/packed.h>
+#include <sudoku/reader.h>
+
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#ifdef _WIN32
+#  ifndef NOMINMAX
+#    define NOMINMAX
+#  endif
+#  include <windows.h>
+#else
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+namespace sudoku {
+
+  namespace {
+
+    constexpr std::array<char, 4> MAGIC = {'S', 'D', 'K', 'P'};
+
+    void storeLittleEndian(std::uint8_t* out, std::uint64_t value, size_t bytes) {
+      for (size_t i = 0; i < bytes; i++) {
+        out[i] = static_cast<std::uint8_t>(value >> (8 * i));
+      }
+    }
+
+    auto loadLittleEndian(const std::uint8_t* in, size_t bytes) -> std::uint64_t {
+      std::uint64_t value = 0;
+      for (size_t i = 0; i < bytes; i++) {
+        value |= std::uint64_t{in[i]} << (8 * i);
+      }
+      return value;
+    }
+
+    auto makeHeader(size_t count) -> std::array<std::uint8_t, PACKED_HEADER_SIZE> {
+      std::array<std::uint8_t, PACKED_HEADER_SIZE> header{};
+      std::memcpy(header.data(), MAGIC.data(), MAGIC.size());
+      header[4] = PACKED_VERSION;
+      header[5] = static_cast<std::uint8_t>(Classic::BOX_SIZE);
+      storeLittleEndian(&header[6], PACKED_RECORD_SIZE, 2);
+      storeLittleEndian(&header[8], count, 8);
+      return header;
+    }
+
+    // Maps a whole file read-only, returns nullptr for an empty file
+    auto mapFile(const std::string& path, size_t& length) -> const std::uint8_t* {
+#ifdef _WIN32
+      HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+      if (file == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error(fmt::format("Could not open {}", path));
+      }
+      LARGE_INTEGER size;
+      if (GetFileSizeEx(file, &size) == 0) {
+        CloseHandle(file);
+        throw std::runtime_error(fmt::format("Could not read the size of {}", path));
+      }
+      length = static_cast<size_t>(size.QuadPart);
+      if (length == 0) {
+        CloseHandle(file);
+        return nullptr;
+      }
+      // The view keeps the mapping alive once both handles are closed
+      HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+      CloseHandle(file);
+      if (mapping == nullptr) {
+        throw std::runtime_error(fmt::format("Could not map {}", path));
+      }
+      void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+      CloseHandle(mapping);
+      if (view == nullptr) {
+        throw std::runtime_error(fmt::format("Could not map {}", path));
+      }
+      return static_cast<const std::uint8_t*>(view);
+#else
+      int fd = ::open(path.c_str(), O_RDONLY);
+      if (fd < 0) {
+        throw std::runtime_error(fmt::format("Could not open {}", path));
+      }
+      struct stat status{};
+      if (::fstat(fd, &status) != 0) {
+        ::close(fd);
+        throw std::runtime_error(fmt::format("Could not read the size of {}", path));
+      }
+      length = static_cast<size_t>(status.st_size);
+      if (length == 0) {
+        ::close(fd);
+        return nullptr;
+      }
+      // The mapping stays valid once the descriptor is closed
+      void* view = ::mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+      ::close(fd);
+      if (view == MAP_FAILED) {
+        throw std::runtime_error(fmt::format("Could not map {}", path));
+      }
+      return static_cast<const std::uint8_t*>(view);
+#endif
+    }
+
+    void unmapFile(const std::uint8_t* data, size_t length) {
+      if (data == nullptr) {
+        return;
+      }
+#ifdef _WIN32
+      (void)length;
+      UnmapViewOfFile(data);
+#else
+      ::munmap(const_cast<std::uint8_t*>(data), length);
+#endif
+    }
+
+  }  // namespace
+
+  auto packBoard(const Board& board) -> PackedRecord {
+    PackedRecord record{};
+    for (size_t cell = 0; cell < CELLS; cell++) {
+      auto candidates = board.getCell(cell);
+      int digit = candidateCount(candidates) == 1 ? firstDigit(candidates) : 0;
+      record[cell / 2] |= static_cast<std::uint8_t>(digit << (4 * (cell % 2)));
+    }
+    return record;
+  }
+
+  auto tryUnpackBoard(std::span<const std::uint8_t, PACKED_RECORD_SIZE> record,
+                      Board& board) noexcept -> bool {
+    board = Board{};
+    for (size_t cell = 0; cell < CELLS; cell++) {
+      int digit = (record[cell / 2] >> (4 * (cell % 2))) & 0xF;
+      if (digit > static_cast<int>(Classic::SIZE)) {
+        return false;
+      }
+      if (digit != 0) {
+        board.keepOnly(cell, digitMask(digit));
+      }
+    }
+    return true;
+  }
+
+  auto isPackedFile(const std::string& path) -> bool {
+    std::ifstream in(path, std::ios::binary);
+    std::array<char, MAGIC.size()> magic{};
+    return in.read(magic.data(), magic.size()) && magic == MAGIC;
+  }
+
+  PackedReader::PackedReader(const std::string& path) : data(mapFile(path, length)) {
+    if (length < PACKED_HEADER_SIZE || std::memcmp(data, MAGIC.data(), MAGIC.size()) != 0) {
+      unmapFile(data, length);
+      throw std::runtime_error(fmt::format("{} is not a packed sudoku file", path));
+    }
+    if (data[4] != PACKED_VERSION || data[5] != Classic::BOX_SIZE
+        || loadLittleEndian(&data[6], 2) != PACKED_RECORD_SIZE) {
+      unmapFile(data, length);
+      throw std::runtime_error(
+          fmt::format("{} has packed format version {} for boxes of {}, expected {} for {}", path,
+                      data[4], data[5], PACKED_VERSION, Classic::BOX_SIZE));
+    }
+    count = loadLittleEndian(&data[8], 8);
+    if ((length - PACKED_HEADER_SIZE) / PACKED_RECORD_SIZE < count) {
+      unmapFile(data, length);
+      throw std::runtime_error(fmt::format("{} is truncated", path));
+    }
+  }
+
+  PackedReader::~PackedReader() { unmapFile(data, length); }
+
+  auto PackedReader::board(size_t index) const -> Board {
+    Board board;
+    if (!tryUnpackBoard(record(index), board)) {
+      throw std::runtime_error(fmt::format("Packed record {} is not a sudoku", index));
+    }
+    return board;
+  }
+
+  PackedWriter::PackedWriter(const std::string& path)
+      : path(path), file(std::fopen(path.c_str(), "wb")) {
+    if (file == nullptr) {
+      throw std::runtime_error(fmt::format("Could not open {}", path));
+    }
+    // Left at zero records until close(), so an interrupted file reads as empty
+    auto header = makeHeader(0);
+    if (std::fwrite(header.data(), 1, header.size(), file) != header.size()) {
+      std::fclose(file);
+      throw std::runtime_error(fmt::format("Could not write {}", path));
+    }
+  }
+
+  PackedWriter::~PackedWriter() {
+    try {
+      close();
+    } catch (const std::runtime_error&) {
+      // Reported by an explicit close() only
+    }
+  }
+
+  void PackedWriter::write(const Board& board) {
+    auto record = packBoard(board);
+    if (std::fwrite(record.data(), 1, record.size(), file) != record.size()) {
+      throw std::runtime_error(fmt::format("Could not write {}", path));
+    }
+    count++;
+  }
+
+  void PackedWriter::close() {
+    if (file == nullptr) {
+      return;
+    }
+    auto header = makeHeader(count);
+    // Buffered writes may only fail on the flush, earlier failures left the error flag set
+    bool failed = std::ferror(file) != 0 || std::fflush(file) != 0
+                  || std::fseek(file, 0, SEEK_SET) != 0
+                  || std::fwrite(header.data(), 1, header.size(), file) != header.size();
+    failed = std::fclose(file) != 0 || failed;
+    file = nullptr;
+    if (failed) {
+      throw std::runtime_error(fmt::format("Could not write {}", path));
+    }
+  }
+
+  auto packTextFile(const std::string& textPath, const std::string& packedPath) -> size_t {
+    PuzzleReader reader(textPath);
+    PackedWriter writer(packedPath);
+    Board board;
+    while (auto puzzle = reader.next()) {
+      ParseResult result = tryParseBoard(*puzzle, board);
+      if (!result.ok()) {
+        throw std::runtime_error(
+            fmt::format("{}:{}: {}", textPath, reader.lineNumber(), parseErrorMessage(result)));
+      }
+      writer.write(board);
+    }
+    writer.close();
+    return writer.size();
+  }
+
+  auto unpackToText(const std::string& packedPath, const std::string& textPath) -> size_t {
+    PackedReader reader(packedPath);
+    std::ofstream out(textPath, std::ios::binary);
+    if (!out) {
+      throw std::runtime_error(fmt::format("Could not open {}", textPath));
+    }
+    for (size_t i = 0; i < reader.size(); i++) {
+      out << boardToString(reader.board(i)) << '\n';
+    }
+    if (!out.flush()) {
+      throw std::runtime_error(fmt::format("Could not write {}", textPath));
+    }
+    return reader.size();
+  }
+
+}  // namespace sudoku
@@ -0,0 +1,57 @@
+#include <spdlog/spdlog.h>
+#include <sudoku/propagation.h>
+
+namespace sudoku {
+
+  template <size_t BOX>
+  auto propagate(BasicBoard<BOX>& board, PropagationStats& stats, const Tracer* tracer) -> bool {
+    using Board = BasicBoard<BOX>;
+    using Candidates = typename Board::Candidates;
+    stats.runs++;
+    // Checked once, the level test is a call per elimination otherwise
+    const bool logging = Tracer::ENABLED && spdlog::should_log(spdlog::level::debug);
+    bool updated = false;
+    while (board.hasPending()) {
+      size_t cell = board.popPending();
+      Candidates digit = board.getCell(cell);
+      // A cell emptied by a contradiction has nothing to propagate
+      if (candidateCount(digit) != 1) {
+        continue;
+      }
+      stats.solvedCells++;
+      for (auto peer : Board::Geometry::PEER_CELLS[cell]) {
+        stats.peerVisits++;
+        // The mask test first, most peers lack the digit
+        if ((board.getCell(peer) & digit) != 0 && candidateCount(board.getCell(peer)) > 1) {
+          if (logging) {
+            spdlog::debug("Penciling: Removing possible value {} from ({},{})", firstDigit(digit),
+                          Board::rowOf(peer), Board::colOf(peer));
+          }
+          board.removeCandidates(peer, digit);
+          stats.eliminations++;
+          updated = true;
+          if (tracer != nullptr) {
+            tracer->emit(TraceEvent::Kind::Eliminated, Rule::Penciling, peer, digit);
+          }
+          if (board.isSolved(peer)) {
+            if (logging) {
+              spdlog::debug("Penciling: Solved cell with value {} from ({},{})",
+                            firstDigit(board.getCell(peer)), Board::rowOf(peer),
+                            Board::colOf(peer));
+            }
+            if (tracer != nullptr) {
+              tracer->emit(TraceEvent::Kind::Placed, Rule::Penciling, peer, board.getCell(peer));
+            }
+          }
+        }
+      }
+    }
+    return updated;
+  }
+
+  template auto propagate(BasicBoard<2>&, PropagationStats&, const Tracer*) -> bool;
+  template auto propagate(BasicBoard<3>&, PropagationStats&, const Tracer*) -> bool;
+  template auto propagate(BasicBoard<4>&, PropagationStats&, const Tracer*) -> bool;
+  template auto propagate(BasicBoard<5>&, PropagationStats&, const Tracer*) -> bool;
+
+}  // namespace sudoku
@@ -0,0 +1,76 @@
+#include <fmt/format.h>
+#include <sudoku/reader.h>
+
+#include <cctype>
+#include <cstring>
+#include <stdexcept>
+
+namespace sudoku {
+
+  PuzzleReader::PuzzleReader(const std::string& path, size_t chunkSize)
+      : file(std::fopen(path.c_str(), "rb")), buffer(chunkSize), chunkSize(chunkSize) {
+    if (file == nullptr) {
+      throw std::runtime_error(fmt::format("Could not open {}", path));
+    }
+  }
+
+  PuzzleReader::~PuzzleReader() { std::fclose(file); }
+
+  // Move the unread tail to the front and read another chunk behind it
+  auto PuzzleReader::fill() -> bool {
+    if (eof) {
+      return false;
+    }
+    size_t remaining = end - begin;
+    if (begin > 0) {
+      std::memmove(buffer.data(), buffer.data() + begin, remaining);
+      begin = 0;
+      end = remaining;
+    }
+    // Only a line longer than the buffer makes it grow
+    if (buffer.size() - end < chunkSize) {
+      buffer.resize(end + chunkSize);
+    }
+    size_t read = std::fread(buffer.data() + end, 1, chunkSize, file);
+    end += read;
+    if (read < chunkSize) {
+      eof = true;
+    }
+    return read > 0;
+  }
+
+  auto PuzzleReader::next() -> std::optional<std::string_view> {
+    while (true) {
+      const char* start = buffer.data() + begin;
+      const auto* newline = static_cast<const char*>(std::memchr(start, '\n', end - begin));
+      size_t length;
+      if (newline != nullptr) {
+        length = static_cast<size_t>(newline - start);
+        begin += length + 1;
+      } else if (fill()) {
+        continue;
+      } else if (begin < end) {
+        // Last line without a newline
+        start = buffer.data() + begin;
+        length = end - begin;
+        begin = end;
+      } else {
+        return std::nullopt;
+      }
+      line++;
+
+      std::string_view text(start, length);
+      while (!text.empty() && std::isspace(static_cast<unsigned char>(text.back())) != 0) {
+        text.remove_suffix(1);
+      }
+      while (!text.empty() && std::isspace(static_cast<unsigned char>(text.front())) != 0) {
+        text.remove_prefix(1);
+      }
+      if (text.empty() || text.front() == '#') {
+        continue;
+      }
+      return text;
+    }
+  }
+
+}  // namespace sudoku
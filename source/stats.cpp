@@ -0,0 +1,42 @@
+#include <fmt/format.h>
+#include <sudoku/stats.h>
+
+#include <chrono>
+#include <string>
+
+namespace sudoku {
+
+  namespace {
+
+    auto micros(std::chrono::nanoseconds time) -> double {
+      return std::chrono::duration<double, std::micro>(time).count();
+    }
+
+  }  // namespace
+
+  auto statsToText(const SolveStats& stats) -> std::string {
+    std::string out = fmt::format("Puzzles: {}\n", stats.puzzles);
+    out += fmt::format("{:<16}{:>12}{:>12}{:>12}{:>14}\n", "Rule", "Invoked", "Fired",
+                       "Eliminated", "Time (us)");
+    for (size_t i = 0; i < RULES; i++) {
+      const RuleStats& rule = stats.rules[i];
+      out += fmt::format("{:<16}{:>12}{:>12}{:>12}{:>14.1f}\n", ruleName(static_cast<Rule>(i)),
+                         rule.invoked, rule.fired, rule.eliminated, micros(rule.time));
+    }
+    return out;
+  }
+
+  auto statsToJson(const SolveStats& stats) -> std::string {
+    std::string out = fmt::format("{{\"puzzles\":{},\"rules\":[", stats.puzzles);
+    for (size_t i = 0; i < RULES; i++) {
+      const RuleStats& rule = stats.rules[i];
+      out += fmt::format(
+          "{}{{\"rule\":\"{}\",\"invoked\":{},\"fired\":{},\"eliminated\":{},\"time_us\":{:.1f}}}",
+          i == 0 ? "" : ",", ruleName(static_cast<Rule>(i)), rule.invoked, rule.fired,
+          rule.eliminated, micros(rule.time));
+    }
+    out += "]}";
+    return out;
+  }
+
+}  // namespace sudoku
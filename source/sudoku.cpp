@@ -1,161 +1,352 @@
 #include <fmt/format.h>
 #include <spdlog/spdlog.h>
+#include <sudoku/io.h>
+#include <sudoku/propagation.h>
 #include <sudoku/sudoku.h>
 
 #include <algorithm>
 #include <array>
+#include <bit>
+#include <cctype>
+#include <chrono>
+#include <cstdint>
 #include <iostream>
+#include <iterator>
+#include <optional>
 #include <print>
-#include <ranges>
-#include <set>
-#include <sstream>
+#include <span>
+#include <stdexcept>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
 namespace sudoku {
 
-  Sudoku::Sudoku(std::string initial_state_str) {
-    if (initial_state_str.size() != ROWS * COLS) {
-      throw std::invalid_argument(
-          fmt::format("Sudoku string was {}, expected {}", initial_state_str.size(), ROWS * COLS));
+  namespace {
+
+    // The candidate table is only built when the level is enabled. Like every log call in the
+    // rules it is compiled out with SUDOKU_TRACE=0
+    template <typename Game> void logBoard(spdlog::level::level_enum level, const Game& game) {
+      if constexpr (Tracer::ENABLED) {
+        if (spdlog::should_log(level)) {
+          spdlog::log(level, "\n{}", game.toDebugTable());
+        }
+      }
     }
 
-    Board initial_state = {};
-    std::ranges::replace(initial_state_str, '.', '0');
-    for (size_t i = 0; i < ROWS; i++) {
-      for (size_t j = 0; j < COLS; j++) {
-        int value = initial_state_str[convertRCtoI(i, j)] - '0';
-        if (value != 0) {
-          initial_state.getCell(i, j).keepOnly(value);
+    // Largest subset looked for, a naked quint is a hidden quad of the remaining cells
+    constexpr int SUBSET_MAX = 4;
+
+    /**
+     * Extends a combination of masks, bit i of chosen standing for masks[i], until it holds size
+     * of them. Returns the combination if their union has exactly size bits and another mask
+     * still overlaps it, 0 if no extension does. Masks that would push the union past size bits
+     * are skipped, which prunes most of the search.
+     *
+     * With cell candidates as masks this finds naked subsets, with the digit positions of a unit
+     * hidden subsets.
+     */
+    template <typename Mask, size_t N>
+    auto findSubset(const std::array<Mask, N>& masks, size_t count, size_t first, int size,
+                    Mask digits, std::uint32_t chosen) -> std::uint32_t {
+      if (std::popcount(chosen) == size) {
+        if (candidateCount(digits) != size) {
+          return 0;
+        }
+        for (size_t i = 0; i < count; i++) {
+          if ((chosen & (1U << i)) == 0 && (masks[i] & digits) != 0) {
+            return chosen;
+          }
         }
+        return 0;
       }
+      for (size_t i = first; i < count; i++) {
+        auto merged = static_cast<Mask>(digits | masks[i]);
+        if (candidateCount(merged) > size) {
+          continue;
+        }
+        auto found = findSubset(masks, count, i + 1, size, merged, chosen | (1U << i));
+        if (found != 0) {
+          return found;
+        }
+      }
+      return 0;
     }
-    state.push_back(initial_state);
-    spdlog::debug("Sudoku instance created");
-  }
 
-  // Return number of snapshots (steps taken)
-  auto Sudoku::stepsTaken() const -> size_t { return state.size(); }
+    /**
+     * Runs a rule on parts 0 to count - 1 of the board, units or digits. Sweep::First stops at the
+     * first part that changes something, Sweep::All repeats each part until it stops changing.
+     */
+    template <typename Part> auto sweepParts(Sweep sweep, size_t count, Part part) -> bool {
+      bool updated = false;
+      for (size_t i = 0; i < count; i++) {
+        if (sweep == Sweep::First) {
+          if (part(i)) {
+            return true;
+          }
+          continue;
+        }
+        while (part(i)) {
+          updated = true;
+        }
+      }
+      return updated;
+    }
 
-  auto Sudoku::toString() const -> std::string {
-    std::string s;
-    s.reserve(ROWS * COLS);  // avoid reallocations
+    // Rule names compare without case, spaces and dashes, "Hidden Singles" as "hidden-singles"
+    auto sameRuleName(std::string_view name, std::string_view spec) -> bool {
+      auto skip = [](char c) { return c == ' ' || c == '-'; };
+      size_t i = 0;
+      size_t j = 0;
+      while (true) {
+        while (i < name.size() && skip(name[i])) {
+          i++;
+        }
+        while (j < spec.size() && skip(spec[j])) {
+          j++;
+        }
+        if (i == name.size() || j == spec.size()) {
+          return i == name.size() && j == spec.size();
+        }
+        if (std::tolower(static_cast<unsigned char>(name[i++]))
+            != std::tolower(static_cast<unsigned char>(spec[j++]))) {
+          return false;
+        }
+      }
+    }
 
-    for (size_t i = 0; i < ROWS * COLS; i++) {
-      for (size_t j = 0; j < COLS; j++) {
-        const auto& cell = state.back().getCell(i, j);
-        if (cell.candidateCount() == 1) {
-          s.push_back(static_cast<char>('0' + cell.toVector()[0]));
-        } else {
-          s.push_back('.');
+    void checkRules(std::span<const Rule> rules) {
+      std::array<bool, RULES> seen{};
+      for (Rule rule : rules) {
+        if (rule == Rule::Search) {
+          throw std::invalid_argument("Search is not a logical rule");
         }
+        if (seen[static_cast<size_t>(rule)]) {
+          throw std::invalid_argument(fmt::format("Rule {} is repeated", ruleName(rule)));
+        }
+        seen[static_cast<size_t>(rule)] = true;
+      }
+    }
+
+  }  // namespace
+
+  auto parseRules(std::string_view spec) -> std::vector<Rule> {
+    if (sameRuleName("all", spec)) {
+      return {LOGIC_RULES.begin(), LOGIC_RULES.end()};
+    }
+    if (sameRuleName("singles", spec)) {
+      return {SINGLES_RULES.begin(), SINGLES_RULES.end()};
+    }
+    std::vector<Rule> rules;
+    while (!spec.empty()) {
+      size_t comma = std::min(spec.find(','), spec.size());
+      std::string_view name = spec.substr(0, comma);
+      spec.remove_prefix(std::min(comma + 1, spec.size()));
+      auto rule = std::ranges::find_if(
+          LOGIC_RULES, [name](Rule candidate) { return sameRuleName(ruleName(candidate), name); });
+      if (rule == LOGIC_RULES.end()) {
+        throw std::invalid_argument(fmt::format("Unknown rule '{}'", name));
       }
+      rules.push_back(*rule);
     }
+    checkRules(rules);
+    return rules;
+  }
+
+  template <size_t BOX>
+  BasicSudoku<BOX>::BasicSudoku(std::string_view initial_state_str, History history)
+      : BasicSudoku(parseBoard<BOX>(initial_state_str), history) {}
 
-    return s;
+  template <size_t BOX>
+  BasicSudoku<BOX>::BasicSudoku(const Board& initial, History history)
+      : board(initial), keepHistory(history == History::Keep) {
+    stepMarks.push_back(0);
+    solveStats.puzzles = 1;
+    if constexpr (Tracer::ENABLED) {
+      spdlog::debug("Sudoku instance created");
+    }
   }
 
-  auto Sudoku::toTable() const -> std::string {
-    std::ostringstream out;
+  template <size_t BOX> void BasicSudoku<BOX>::load(std::string_view initial_state_str) {
+    load(parseBoard<BOX>(initial_state_str));
+  }
 
-    for (size_t row = 0; row < ROWS; row++) {
-      if (row % 3 == 0 && row != 0) {
-        out << "------+-------+------\n";  // horizontal separator
-      }
+  template <size_t BOX> void BasicSudoku<BOX>::load(const Board& initial) {
+    board = initial;
+    changes.clear();
+    stepMarks.clear();
+    stepMarks.push_back(0);
+    steps = 1;
+    propagationStats = {};
+    solveStats = {};
+    solveStats.puzzles = 1;
+    boardVersion++;
+  }
 
-      for (size_t col = 0; col < COLS; col++) {
-        if (col % 3 == 0 && col != 0) {
-          out << "| ";  // vertical separator
-        }
+  // Return number of snapshots (steps taken)
+  template <size_t BOX> auto BasicSudoku<BOX>::stepsTaken() const -> size_t { return steps; }
+
+  template <size_t BOX> void BasicSudoku<BOX>::rewind(size_t step) {
+    if (!keepHistory || step >= steps) {
+      throw std::out_of_range(fmt::format("Cannot rewind to step {} of {}{}", step, steps,
+                                          keepHistory ? "" : " without history"));
+    }
+    board.changeLog = &changes;
+    board.rewind(stepMarks[step]);
+    board.changeLog = nullptr;
+    stepMarks.resize(step + 1);
+    steps = step + 1;
+    boardVersion++;
+  }
 
-        const auto& cell = state.back().getCell(row, col);
-        if (cell.candidateCount() == 1) {
-          int val = cell.toVector()[0];
-          out << val << " ";
-        } else {
-          out << ". ";
-        }
-      }
-      out << "\n";
+  template <size_t BOX> void BasicSudoku<BOX>::beginStep() {
+    if (keepHistory) {
+      board.changeLog = &changes;
+    }
+  }
+
+  template <size_t BOX> void BasicSudoku<BOX>::endStep() {
+    board.changeLog = nullptr;
+    if (keepHistory) {
+      stepMarks.push_back(changes.size());
     }
+    steps++;
+  }
 
-    return out.str();  // return the whole table as a string
+  template <size_t BOX> void BasicSudoku<BOX>::setTraceSink(TraceSink sink) {
+    tracer.setSink(std::move(sink));
   }
 
-  auto Sudoku::toDebug() -> std::string {
-    std::ostringstream out;
+  template <size_t BOX> void BasicSudoku<BOX>::setRules(std::span<const Rule> rules) {
+    checkRules(rules);
+    pipeline.assign(rules.begin(), rules.end());
+  }
+
+  template <size_t BOX> auto BasicSudoku<BOX>::getRules() const -> std::span<const Rule> {
+    return pipeline;
+  }
+
+  template <size_t BOX> void BasicSudoku<BOX>::setSweep(Sweep mode) { sweep = mode; }
+
+  template <size_t BOX> auto BasicSudoku<BOX>::getSweep() const -> Sweep { return sweep; }
+
+  template <size_t BOX>
+  auto BasicSudoku<BOX>::eliminate(Rule rule, size_t cell, Candidates mask) -> bool {
+    Candidates removed = board.getCell(cell) & mask;
+    if (!board.removeCandidates(cell, mask)) {
+      return false;
+    }
+    solveStats[rule].eliminated += static_cast<size_t>(candidateCount(removed));
+    tracer.emit(TraceEvent::Kind::Eliminated, rule, cell, removed);
+    if (board.isSolved(cell)) {
+      tracer.emit(TraceEvent::Kind::Placed, rule, cell, board.getCell(cell));
+    }
+    return true;
+  }
+
+  template <size_t BOX>
+  auto BasicSudoku<BOX>::keepOnly(Rule rule, size_t cell, Candidates mask) -> bool {
+    return eliminate(rule, cell, static_cast<Candidates>(ALL_CANDIDATES & ~mask));
+  }
+
+  template <size_t BOX>
+  auto BasicSudoku<BOX>::getPropagationStats() const -> const PropagationStats& {
+    return propagationStats;
+  }
+
+  template <size_t BOX> auto BasicSudoku<BOX>::getSolveStats() const -> const SolveStats& {
+    return solveStats;
+  }
+
+  template <size_t BOX> auto BasicSudoku<BOX>::toString() const -> std::string {
+    return boardToString(board);
+  }
+
+  template <size_t BOX> auto BasicSudoku<BOX>::toTable() const -> std::string {
+    return boardToTable(board);
+  }
+
+  template <size_t BOX>
+  auto BasicSudoku<BOX>::writeString(std::span<char> buffer) const noexcept -> size_t {
+    return writeBoard(board, buffer);
+  }
+
+  template <size_t BOX> auto BasicSudoku<BOX>::toDebug() -> std::string {
+    std::string text;
+    auto out = std::back_inserter(text);
 
     for (size_t row = 0; row < ROWS; row++) {
       for (size_t col = 0; col < COLS; col++) {
-        out << " (" << row << "," << col << "): ";
-        const auto& cell = getCell(row, col);
-        for (int value : cell.toVector()) {
-          out << value;
+        out = fmt::format_to(out, " ({},{}): ", row, col);
+        Candidates cell = getCell(row, col);
+        for (int value = 1; value <= static_cast<int>(SIZE); value++) {
+          if (hasDigit(cell, value)) {
+            *out++ = digitChar(value);
+          }
         }
-        out << "\n";
+        *out++ = '\n';
       }
     }
 
-    return out.str();  // return the whole table as a string
+    return text;
   }
 
-  auto Sudoku::toDebugTable() const -> std::string {
-    std::ostringstream out;
+  template <size_t BOX> auto BasicSudoku<BOX>::toDebugTable() const -> std::string {
+    // Every cell shows its candidates as a BOX x BOX block
+    auto rule = [](char fill, char cross) {
+      std::string line;
+      for (size_t box = 0; box < BOX; box++) {
+        if (box != 0) {
+          line += cross;
+        }
+        line.append((BOX * (BOX + 1)) + (box != 0 ? 1 : 0) - (box == BOX - 1 ? 1 : 0), fill);
+      }
+      return line + "\n";
+    };
+    const std::string separator = rule('-', '+');
+    const std::string spacer = rule(' ', '|');
 
-    out << toTable();
+    std::string text;
+    auto out = formatTable(board, std::back_inserter(text));
     for (size_t row = 0; row < ROWS; row++) {
-      if (row % 3 == 0 && row != 0) {
-        out << "------------+-------------+------------\n";
-        out << "            |             |            \n";
+      if (row % BOX == 0 && row != 0) {
+        out = std::ranges::copy(separator, out).out;
+        out = std::ranges::copy(spacer, out).out;
       }
 
-      for (size_t colRow = 0; colRow < 3; colRow++) {
+      for (size_t colRow = 0; colRow < BOX; colRow++) {
         for (size_t col = 0; col < COLS; col++) {
-          if (col % 3 == 0 && col != 0) {
-            out << "| ";
+          if (col % BOX == 0 && col != 0) {
+            *out++ = '|';
+            *out++ = ' ';
           }
 
-          const Cell& cell = state.back().getCell(row, col);
-          if (cell.hasCandidate((3 * colRow) + 1)) {
-            out << (3 * colRow) + 1;
-          } else {
-            out << ".";
-          }
-          if (cell.hasCandidate((3 * colRow) + 2)) {
-            out << (3 * colRow) + 2;
-          } else {
-            out << ".";
-          }
-          if (cell.hasCandidate((3 * colRow) + 3)) {
-            out << (3 * colRow) + 3;
-          } else {
-            out << ".";
+          Candidates cell = getCell(row, col);
+          for (size_t k = 1; k <= BOX; k++) {
+            int digit = static_cast<int>((BOX * colRow) + k);
+            *out++ = hasDigit(cell, digit) ? digitChar(digit) : '.';
           }
-          out << " ";
+          *out++ = ' ';
         }
-        out << "\n";
-        if (colRow == 2 && row != 8) {
-          out << "            |             |            \n";
+        *out++ = '\n';
+        if (colRow == BOX - 1 && row != ROWS - 1) {
+          out = std::ranges::copy(spacer, out).out;
         }
       }
     }
 
-    return out.str();  // return the whole table as a string
+    return text;
   }
 
-  // Definition of the overloaded << operator
-  std::ostream& operator<<(std::ostream& os, const Sudoku& s) {
-    os << s.toString();
-    return os;
+  template <size_t BOX> auto BasicSudoku<BOX>::convertRCtoI(size_t row, size_t col) -> size_t {
+    return (row * COLS) + col;
   }
 
-  auto Sudoku::convertRCtoI(size_t row, size_t col) -> size_t { return (row * COLS) + col; }
-
-  auto Sudoku::solved() const -> bool {
+  template <size_t BOX> auto BasicSudoku<BOX>::solved() const -> bool {
     for (size_t i = 0; i < ROWS; i++) {
       for (size_t j = 0; j < COLS; j++) {
-        if (state.back().getCell(i, j).candidateCount() != 1) {
+        if (candidateCount(getCell(i, j)) != 1) {
           return false;
         }
       }
@@ -164,515 +355,505 @@ namespace sudoku {
     return true;
   }
 
-  auto Sudoku::getCell(size_t row, size_t col) -> Cell& { return state.back().getCell(row, col); }
-  auto Sudoku::getCell(size_t row, size_t col) const -> const Cell& {
-    return state.back().getCell(row, col);
+  template <size_t BOX> auto BasicSudoku<BOX>::getCell(size_t row, size_t col) const -> Candidates {
+    return board.getCell(row, col);
   }
 
-  auto Sudoku::getRow(size_t row) -> Group {
-    return state.back().getRow(row);
-  }
+  template <size_t BOX> auto BasicSudoku<BOX>::solveRulePenciling() -> bool {
+    size_t eliminations = propagationStats.eliminations;
+    bool updated = propagate(board, propagationStats, &tracer);
+    solveStats[Rule::Penciling].eliminated += propagationStats.eliminations - eliminations;
+    if (updated) {
+      logBoard(spdlog::level::debug, *this);
+      return true;
+    }
 
-  auto Sudoku::getCol(size_t col) -> Group {
-    return state.back().getCol(col);
+    return false;
   }
 
-  auto Sudoku::getBlock(size_t row, size_t col) -> Group {
-    return state.back().getBlock(row,col);
-  }
+  template <size_t BOX> auto BasicSudoku<BOX>::solveRuleHiddenSinglesUnit(size_t unit) -> bool {
+    const Unit& cells = Board::getUnit(unit);
 
-  auto Sudoku::solveRulePencilingCellWithGroup(Cell& cell, const Group& group) -> bool {
-    for (const Cell& groupCell : group) {
-      for (auto candidate : cell.toVector()) {
-        if (groupCell.candidateCount() == 1
-            && (groupCell.row != cell.row || groupCell.col != cell.col)
-            && groupCell.hasCandidate(candidate)
-            && cell.hasCandidate(candidate)) {
-          spdlog::debug("Penciling: Removing possible value {} from ({},{})", candidate, cell.row,
-                        cell.col);
-          cell.removeCandidate(candidate);
-          if (cell.candidateCount() == 1) {
-            spdlog::debug("Penciling: Solved cell with value {} from ({},{})", cell.toVector().front(), cell.row,
-                          cell.col);
-          }
-          return true;
-        }
-      }
+    // Digits seen in at least one and in at least two cells of the unit
+    Candidates once = 0;
+    Candidates twice = 0;
+    for (auto cell : cells) {
+      twice |= once & board.getCell(cell);
+      once |= board.getCell(cell);
     }
-    return false;
-  }
-
-  auto Sudoku::solveRulePencilingCell(Cell& cell) -> bool {
-    if (cell.candidateCount() > 1) {
-      std::vector<Group> groups = {state.back().getRow(cell.row), state.back().getCol(cell.col),
-                                   state.back().getBlock(cell.row, cell.col)};
-      for (const auto& group : groups) {
-        if (solveRulePencilingCellWithGroup(cell, group)) {
-          return true;
-        }
-      }
+    Candidates singles
+        = once & static_cast<Candidates>(~twice) & static_cast<Candidates>(~board.unitDigits(unit));
+    if (singles == 0) {
+      return false;
     }
-    return false;
-  }
 
-  auto Sudoku::solveRulePenciling() -> bool {
-    bool updatedLoop;
     bool updated = false;
-    do {
-      updatedLoop = false;
-      for (size_t row = 0; row < ROWS; row++) {
-        for (size_t col = 0; col < COLS; col++) {
-          if (solveRulePencilingCell(getCell(row, col))) {
-            updated = true;
-            updatedLoop = true;
-          }
+    for (auto cell : cells) {
+      Candidates single = board.getCell(cell) & singles;
+      if (single != 0 && candidateCount(board.getCell(cell)) > 1) {
+        if constexpr (Tracer::ENABLED) {
+          spdlog::debug("Hidden Singles: Found {} only in cell ({},{})", firstDigit(single),
+                        Board::rowOf(cell), Board::colOf(cell));
         }
+        updated |= keepOnly(Rule::HiddenSingles, cell, single);
       }
-    } while (updatedLoop);
+    }
     if (updated) {
-      spdlog::debug("\n{}", toDebugTable());
-      return true;
+      logBoard(spdlog::level::debug, *this);
     }
+    return updated;
+  }
 
-    return false;
+  template <size_t BOX> auto BasicSudoku<BOX>::solveRuleHiddenSingles() -> bool {
+    if constexpr (Tracer::ENABLED) {
+      spdlog::trace("solveRuleHiddenSingles");
+    }
+    return sweepParts(sweep, UNITS,
+                      [this](size_t unit) { return solveRuleHiddenSinglesUnit(unit); });
   }
 
-  auto Sudoku::solveRulePointingGroups(Group group0, Group group1) -> bool {
-    Group sharedCells;
-    std::set<int> sharedValues;
-    for (auto& g0Cell : group0) {
-      for (auto& g1Cell : group1) {
-        if (g0Cell.row == g1Cell.row && g0Cell.col == g1Cell.col) {
-          sharedCells.add(g0Cell);
-          if (g0Cell.candidateCount() > 1) {
-            for (auto value : g0Cell.toVector()) {
-              sharedValues.insert(value);
-            }
-          }
-          if (g1Cell.candidateCount() > 1) {
-            for (auto value : g1Cell.toVector()) {
-              sharedValues.insert(value);
-            }
-          }
-        }
+  template <size_t BOX>
+  auto BasicSudoku<BOX>::solveRulePointingSegment(const Segment& segment) -> bool {
+    Candidates shared = 0;
+    for (auto cell : segment.cells) {
+      if (candidateCount(board.getCell(cell)) > 1) {
+        shared |= board.getCell(cell);
       }
     }
-    spdlog::trace("  Found {} shared cells", sharedCells.size());
+    if (shared == 0) {
+      return false;
+    }
 
-    Group unsharedGroup0Cells;
-    for (auto& g0Cell : group0) {
-      bool isShared = false;
-      for (const auto& sharedCell : sharedCells) {
-        if (g0Cell.row == sharedCell.row && g0Cell.col == sharedCell.col) {
-          isShared = true;
-        }
+    Candidates lineRest = 0;
+    for (auto cell : segment.lineRest) {
+      lineRest |= board.getCell(cell);
+    }
+    Candidates boxRest = 0;
+    for (auto cell : segment.boxRest) {
+      boxRest |= board.getCell(cell);
+    }
+
+    // Digits the box only has in the segment leave the rest of the line (pointing), digits the
+    // line only has in the segment leave the rest of the box (claiming)
+    Candidates pointing = shared & lineRest & static_cast<Candidates>(~boxRest);
+    Candidates claiming = shared & boxRest & static_cast<Candidates>(~lineRest);
+    bool updated = false;
+    if (pointing != 0) {
+      if constexpr (Tracer::ENABLED) {
+        spdlog::debug("Pointing: Box {} holds {:#05x} only in line {}", segment.box, pointing,
+                      segment.line);
       }
-      if (!isShared) {
-        unsharedGroup0Cells.add(g0Cell);
+      for (auto cell : segment.lineRest) {
+        updated |= eliminate(Rule::Pointing, cell, pointing);
       }
     }
-    spdlog::trace("  Found {} unshared group0 cells", unsharedGroup0Cells.size());
-
-    Group unsharedGroup1Cells;
-    for (auto& g1Cell : group1) {
-      bool isShared = false;
-      for (const auto& sharedCell : sharedCells) {
-        if (g1Cell.row == sharedCell.row && g1Cell.col == sharedCell.col) {
-          isShared = true;
-        }
+    if (claiming != 0) {
+      if constexpr (Tracer::ENABLED) {
+        spdlog::debug("Pointing: Line {} holds {:#05x} only in box {}", segment.line, claiming,
+                      segment.box);
       }
-      if (!isShared) {
-        unsharedGroup1Cells.add(g1Cell);
+      for (auto cell : segment.boxRest) {
+        updated |= eliminate(Rule::Pointing, cell, claiming);
       }
     }
-    spdlog::trace("  Found {} unshared group1 cells", unsharedGroup1Cells.size());
+    return updated;
+  }
 
-    spdlog::trace("  Found {} shared values", sharedValues.size());
+  template <size_t BOX> auto BasicSudoku<BOX>::solveRulePointing() -> bool {
+    if constexpr (Tracer::ENABLED) {
+      spdlog::trace("solveRulePointing");
+    }
+    // Segments are independent enough that one pass applies every elimination it finds
     bool updated = false;
-    if (sharedValues.size() > 0) {
-      for (auto sharedValue : sharedValues) {
-        bool valueFoundOutsideOfSharedGroup0 = false;
-        bool valueFoundOutsideOfSharedGroup1 = false;
-        spdlog::trace("    {}", sharedValue);
-        //  check if in unshared group0 cells
-        for (const auto& unsharedGroup0Cell : unsharedGroup0Cells) {
-          if (unsharedGroup0Cell.hasCandidate(sharedValue)) {
-            valueFoundOutsideOfSharedGroup0 = true;
-            spdlog::trace("    {} found outside of shared cells in group0", sharedValue);
-            break;
-          }
-        }
-        // check if in unshared group1 cells
-        for (const auto& unsharedGroup1Cell : unsharedGroup1Cells) {
-          if (unsharedGroup1Cell.hasCandidate(sharedValue)) {
-            valueFoundOutsideOfSharedGroup1 = true;
-            spdlog::trace("    {} found outside of shared cells in group1", sharedValue);
-            break;
-          }
-        }
-        if (valueFoundOutsideOfSharedGroup0 && !valueFoundOutsideOfSharedGroup1) {
-          spdlog::trace("\n{}", toDebugTable());
-          spdlog::trace("    {} only in found in unshared cells in group0", sharedValue);
-          for (auto& unsharedGroup0Cell : unsharedGroup0Cells) {
-            spdlog::debug("Pointing: Removing possible value {} from ({},{})", sharedValue,
-                          unsharedGroup0Cell.row, unsharedGroup0Cell.col);
-            unsharedGroup0Cell.removeCandidate(sharedValue);
-          }
-          updated = true;
-        } else if (!valueFoundOutsideOfSharedGroup0 && valueFoundOutsideOfSharedGroup1) {
-          spdlog::trace("\n{}", toDebugTable());
-          spdlog::trace("    {} only in found in unshared cells in group1", sharedValue);
-          for (auto& unsharedGroup1Cell : unsharedGroup1Cells) {
-            spdlog::debug("Pointing: Removing possible value {} from ({},{})", sharedValue,
-                          unsharedGroup1Cell.row, unsharedGroup1Cell.col);
-            unsharedGroup1Cell.removeCandidate(sharedValue);
-          }
-          updated = true;
-        } else if (valueFoundOutsideOfSharedGroup0 && valueFoundOutsideOfSharedGroup1) {
-          spdlog::trace("   {} found in unshared cells in both groups", sharedValue);
-        } else {
-          spdlog::trace("   {} not found in unshared cells in either group", sharedValue);
-        }
-      }
+    for (const auto& segment : Geometry::SEGMENT_CELLS) {
+      updated |= solveRulePointingSegment(segment);
     }
-
     if (updated) {
-      spdlog::debug("\n{}", toDebugTable());
-      return true;
+      logBoard(spdlog::level::debug, *this);
     }
-
-    return false;
+    return updated;
   }
 
-  auto Sudoku::solveRulePointing() -> bool {
-    for (size_t row = 0; row < ROWS; row++) {
-      for (size_t col = 0; col < COLS; col += 3) {
-        spdlog::trace("Pointing - Row - ({},{})", row, col);
-        if (solveRulePointingGroups(getRow(row), getBlock(row, col))) {
-          return true;
-        }
+  template <size_t BOX> auto BasicSudoku<BOX>::solveRuleNakedSubsetsUnit(size_t unit) -> bool {
+    // Unsolved cells of the unit and their candidates
+    std::array<CellIndex, UNIT_SIZE> cells{};
+    std::array<Candidates, UNIT_SIZE> masks{};
+    size_t count = 0;
+    for (auto cell : Board::getUnit(unit)) {
+      if (candidateCount(board.getCell(cell)) > 1) {
+        cells[count] = cell;
+        masks[count] = board.getCell(cell);
+        count++;
       }
     }
-    for (size_t col = 0; col < COLS; col++) {
-      for (size_t row = 0; row < ROWS; row += 3) {
-        spdlog::trace("Pointing - Col - ({},{})", row, col);
-        if (solveRulePointingGroups(getCol(col), getBlock(row, col))) {
-          return true;
+
+    for (int size = 2; size <= SUBSET_MAX && static_cast<size_t>(size) < count; size++) {
+      std::uint32_t chosen = findSubset(masks, count, 0, size, Candidates{0}, 0);
+      if (chosen == 0) {
+        continue;
+      }
+      Candidates digits = 0;
+      for (size_t i = 0; i < count; i++) {
+        if ((chosen & (1U << i)) != 0) {
+          digits |= masks[i];
+        }
+      }
+      if constexpr (Tracer::ENABLED) {
+        spdlog::debug("Naked Subsets: {} cells of unit {} share {} digits", size, unit, size);
+      }
+      for (size_t i = 0; i < count; i++) {
+        if ((chosen & (1U << i)) == 0) {
+          eliminate(Rule::NakedSubsets, cells[i], digits);
         }
       }
+      logBoard(spdlog::level::debug, *this);
+      return true;
     }
     return false;
   }
 
-  std::vector<std::pair<int, int>> makeCandidatePairs(const std::set<int>& candidates) {
-    std::vector<int> vals(candidates.begin(), candidates.end());
-
-    auto indices = std::views::iota(0, (int)vals.size());
-
-    std::vector<std::pair<int, int>> result;
-    for (int i : indices) {
-      for (int j : std::views::iota(i + 1, (int)vals.size())) {
-        result.emplace_back(vals[i], vals[j]);
-      }
+  template <size_t BOX> auto BasicSudoku<BOX>::solveRuleNakedSubsets() -> bool {
+    if constexpr (Tracer::ENABLED) {
+      spdlog::trace("solveRuleNakedSubsets");
     }
-    return result;
+    return sweepParts(sweep, UNITS,
+                      [this](size_t unit) { return solveRuleNakedSubsetsUnit(unit); });
   }
 
-  std::vector<std::tuple<int, int, int>> makeCandidateTuples(const std::set<int>& candidates) {
-    std::vector<int> vals(candidates.begin(), candidates.end());
+  template <size_t BOX> auto BasicSudoku<BOX>::solveRuleHiddenSubsetsUnit(size_t unit) -> bool {
+    const Unit& cells = Board::getUnit(unit);
 
-    std::vector<std::tuple<int, int, int>> result;
-    for (size_t i = 0; i < vals.size(); ++i) {
-      for (size_t j = i + 1; j < vals.size(); ++j) {
-        for (size_t k = j + 1; k < vals.size(); ++k) {
-          result.emplace_back(vals[i], vals[j], vals[k]);
-        }
+    // Transpose the unit: for every digit not placed yet, the mask of slots still allowing it
+    std::array<Candidates, UNIT_SIZE> positions{};
+    std::array<int, UNIT_SIZE> digits{};
+    size_t count = 0;
+    Candidates open = ALL_CANDIDATES & static_cast<Candidates>(~board.unitDigits(unit));
+    for (int digit = 1; digit <= static_cast<int>(SIZE); digit++) {
+      if (!hasDigit(open, digit)) {
+        continue;
       }
-    }
-
-    return result;
-  }
-
-  auto Sudoku::solveRuleHiddenPairsGroup(Group cellGroup) -> bool {
-    spdlog::trace("solveRuleHiddenPairsGroup");
-
-    // Get all candidates in group and generate pairs
-    std::set<int> candidates;
-    for (auto& cell : cellGroup) {
-      if (cell.candidateCount() > 1) {
-        for (auto candidate : cell.toVector()) {
-          candidates.insert(candidate);
+      Candidates slots = 0;
+      for (size_t slot = 0; slot < UNIT_SIZE; slot++) {
+        if (candidateCount(board.getCell(cells[slot])) > 1
+            && hasDigit(board.getCell(cells[slot]), digit)) {
+          slots |= static_cast<Candidates>(1U << slot);
         }
       }
+      positions[count] = slots;
+      digits[count] = digit;
+      count++;
     }
 
-    // Pair up candidates and check if only two cells have them as a pair
-    for (auto [a, b] : makeCandidatePairs(candidates)) {
-      spdlog::trace("  Candidate pair: ({}, {})", a, b);
-      bool invalidated = false;
-      Group candidateCells = {};
-      for (auto& cell : cellGroup) {
-        bool cellContainsFirstValue = cell.hasCandidate(a);
-        bool cellContainsSecondValue = cell.hasCandidate(b);
-        if (cellContainsFirstValue && cellContainsSecondValue) {
-          candidateCells.add(cell);
-        } else if (cellContainsFirstValue || cellContainsSecondValue) {
-          invalidated = true;
-          break;
+    // N digits confined to N slots, found exactly like N cells holding N digits
+    for (int size = 2; size <= SUBSET_MAX && static_cast<size_t>(size) < count; size++) {
+      std::uint32_t chosen = findSubset(positions, count, 0, size, Candidates{0}, 0);
+      if (chosen == 0) {
+        continue;
+      }
+      Candidates subset = 0;
+      Candidates slots = 0;
+      for (size_t i = 0; i < count; i++) {
+        if ((chosen & (1U << i)) != 0) {
+          subset |= digitMask<Candidates>(digits[i]);
+          slots |= positions[i];
         }
       }
-      if (invalidated) {
-        continue;
+      if constexpr (Tracer::ENABLED) {
+        spdlog::debug("Hidden Subsets: {} digits of unit {} fit in {} cells", size, unit, size);
       }
-      // Check if there are only two candidates
-      // and only process if a cell has mroe then 2 candidates
-      if (candidateCells.size() == 2
-          && (candidateCells[0].candidateCount() > 2 || candidateCells[1].candidateCount() > 2)) {
-        spdlog::debug("Hidden Pairs: Found {} and {} paired in cells ({},{}) and ({},{})", a, b,
-                      candidateCells[0].row, candidateCells[0].col, candidateCells[1].row,
-                      candidateCells[1].col);
-        for (auto& candidateCell : candidateCells) {
-          candidateCell.keepOnly({a, b});
+      for (size_t slot = 0; slot < UNIT_SIZE; slot++) {
+        if ((slots & (1U << slot)) != 0) {
+          keepOnly(Rule::HiddenSubsets, cells[slot], subset);
         }
-        spdlog::debug("\n{}", toDebugTable());
-        return true;
       }
+      logBoard(spdlog::level::debug, *this);
+      return true;
     }
     return false;
   }
 
-  auto Sudoku::solveRuleHiddenPairs() -> bool {
-    spdlog::trace("solveRuleHiddenPairs");
-    for (size_t row = 0; row < ROWS; row++) {
-      if (solveRuleHiddenPairsGroup(getRow(row))) {
-        return true;
-      }
+  template <size_t BOX> auto BasicSudoku<BOX>::solveRuleHiddenSubsets() -> bool {
+    if constexpr (Tracer::ENABLED) {
+      spdlog::trace("solveRuleHiddenSubsets");
     }
-    for (size_t col = 0; col < COLS; col++) {
-      if (solveRuleHiddenPairsGroup(getCol(col))) {
-        return true;
+    return sweepParts(sweep, UNITS,
+                      [this](size_t unit) { return solveRuleHiddenSubsetsUnit(unit); });
+  }
+
+  template <size_t BOX> auto BasicSudoku<BOX>::solveRuleFishDigit(int digit) -> bool {
+    static constexpr std::array<std::string_view, SUBSET_MAX + 1> names
+        = {"", "", "X-Wing", "Swordfish", "Jellyfish"};
+    Candidates mask = digitMask<Candidates>(digit);
+
+    // Base lines are rows and the cover lines columns, then the other way round
+    for (bool byRow : {true, false}) {
+      auto lineUnit = [byRow](size_t line, bool base) {
+        return base == byRow ? Geometry::rowUnit(line) : Geometry::colUnit(line);
+      };
+
+      // For every base line still missing the digit, the mask of cover lines that allow it
+      std::array<Candidates, UNIT_SIZE> covers{};
+      std::array<std::uint8_t, UNIT_SIZE> lines{};
+      size_t count = 0;
+      for (size_t line = 0; line < UNIT_SIZE; line++) {
+        size_t unit = lineUnit(line, true);
+        if ((board.unitDigits(unit) & mask) != 0) {
+          continue;
+        }
+        Candidates cover = 0;
+        const Unit& cells = Board::getUnit(unit);
+        // Without penciling in the pipeline a cell may still list a digit its peers placed
+        for (size_t slot = 0; slot < UNIT_SIZE; slot++) {
+          if (candidateCount(board.getCell(cells[slot])) > 1
+              && (board.getCell(cells[slot]) & mask) != 0
+              && (board.placedPeers(cells[slot]) & mask) == 0) {
+            cover |= static_cast<Candidates>(1U << slot);
+          }
+        }
+        covers[count] = cover;
+        lines[count] = static_cast<std::uint8_t>(line);
+        count++;
       }
-    }
-    for (size_t row = 0; row < ROWS; row += 3) {
-      for (size_t col = 0; col < COLS; col += 3) {
-        if (solveRuleHiddenPairsGroup(getBlock(row, col))) {
-          return true;
+
+      // N base lines whose digit fits in N cover lines, found like a naked subset
+      for (int size = 2; size <= SUBSET_MAX && static_cast<size_t>(size) < count; size++) {
+        std::uint32_t chosen = findSubset(covers, count, 0, size, Candidates{0}, 0);
+        if (chosen == 0) {
+          continue;
+        }
+        Candidates baseLines = 0;
+        Candidates coverLines = 0;
+        for (size_t i = 0; i < count; i++) {
+          if ((chosen & (1U << i)) != 0) {
+            baseLines |= static_cast<Candidates>(1U << lines[i]);
+            coverLines |= covers[i];
+          }
         }
+        if constexpr (Tracer::ENABLED) {
+          spdlog::debug("Fish: {} on {} in {}", names[size], digit, byRow ? "rows" : "columns");
+        }
+        // The digit of the cover lines has to be in the base lines
+        for (size_t line = 0; line < UNIT_SIZE; line++) {
+          if ((coverLines & (1U << line)) == 0) {
+            continue;
+          }
+          const Unit& cells = Board::getUnit(lineUnit(line, false));
+          for (size_t slot = 0; slot < UNIT_SIZE; slot++) {
+            if ((baseLines & (1U << slot)) == 0) {
+              eliminate(Rule::Fish, cells[slot], mask);
+            }
+          }
+        }
+        logBoard(spdlog::level::debug, *this);
+        return true;
       }
     }
     return false;
   }
 
-  auto Sudoku::solveRuleHiddenTuplesGroup(Group cellGroup) -> bool {
-    spdlog::trace("solveRuleHiddenTuplesGroup");
-
-    // Get all candidates in group and generate tuples
-    std::set<int> candidates;
-    for (const auto& cell : cellGroup) {
-      if (cell.candidateCount() > 1) {
-        for (auto candidate : cell.toVector()) {
-          candidates.insert(candidate);
-        }
-      }
+  template <size_t BOX> auto BasicSudoku<BOX>::solveRuleFish() -> bool {
+    if constexpr (Tracer::ENABLED) {
+      spdlog::trace("solveRuleFish");
     }
+    return sweepParts(sweep, UNIT_SIZE, [this](size_t part) {
+      return solveRuleFishDigit(static_cast<int>(part) + 1);
+    });
+  }
 
-    // Tuple up candidates and check if only three cells have them
-    for (auto [a, b, c] : makeCandidateTuples(candidates)) {
-      spdlog::trace("  Candidate tuple: ({}, {}, {})", a, b, c);
-      bool invalidated = false;
-      Group candidateCells = {};
-      for (auto& cell : cellGroup) {
-        bool cellContainsFirstValue = cell.hasCandidate(a);
-        bool cellContainsSecondValue = cell.hasCandidate(b);
-        bool cellContainsThirdValue = cell.hasCandidate(c);
-        if ((cellContainsFirstValue && cellContainsSecondValue)
-            || (cellContainsFirstValue && cellContainsThirdValue)
-            || (cellContainsSecondValue && cellContainsThirdValue)) {
-          candidateCells.add(cell);
-        } else if (cellContainsFirstValue || cellContainsSecondValue || cellContainsThirdValue) {
-          invalidated = true;
-          break;
-        }
-      }
-      if (invalidated) {
+  template <size_t BOX> auto BasicSudoku<BOX>::applyRules() -> bool {
+    using Step = bool (BasicSudoku::*)();
+
+    // Indexed by Rule
+    static constexpr std::array<Step, RULES - 1> ruleSteps = {
+        &BasicSudoku::solveRulePenciling,
+        &BasicSudoku::solveRuleHiddenSingles,
+        &BasicSudoku::solveRulePointing,
+        &BasicSudoku::solveRuleNakedSubsets,
+        &BasicSudoku::solveRuleHiddenSubsets,
+        &BasicSudoku::solveRuleFish,
+    };
+
+    for (Rule rule : pipeline) {
+      // Rules only look at the board, one that found nothing will find nothing again
+      size_t& idle = idleVersion[static_cast<size_t>(rule)];
+      if (idle == boardVersion) {
         continue;
       }
-      // Check if there are only three candidates
-      // and only process if a cell has more then 3 candidates
-      if (candidateCells.size() == 3
-          && (candidateCells[0].candidateCount() > 3 || candidateCells[1].candidateCount() > 3
-              || candidateCells[2].candidateCount() > 3)) {
-        spdlog::debug(
-            "Hidden Tuples: Found {}, {}, and {} paired in cells ({},{}), ({},{}) and ({},{})", a,
-            b, c, candidateCells[0].row, candidateCells[0].col, candidateCells[1].row,
-            candidateCells[1].col, candidateCells[2].row, candidateCells[2].col);
-        for (auto& candidateCell : candidateCells) {
-          candidateCell.keepOnly({a, b, c});
-        }
-        spdlog::debug("\n{}", toDebugTable());
+      RuleStats& stats = solveStats[rule];
+      stats.invoked++;
+      Step step = ruleSteps[static_cast<size_t>(rule)];
+      bool fired = false;
+      if (timeRules) {
+        auto start = std::chrono::steady_clock::now();
+        fired = (this->*step)();
+        stats.time += std::chrono::steady_clock::now() - start;
+      } else {
+        fired = (this->*step)();
+      }
+      if (fired) {
+        stats.fired++;
+        boardVersion++;
         return true;
       }
+      idle = boardVersion;
     }
     return false;
   }
 
-  auto Sudoku::solveRuleHiddenTuples() -> bool {
-    spdlog::trace("solveRuleHiddenTuples");
-    for (size_t row = 0; row < ROWS; row++) {
-      if (solveRuleHiddenTuplesGroup(getRow(row))) {
-        return true;
-      }
-    }
-    for (size_t col = 0; col < COLS; col++) {
-      if (solveRuleHiddenTuplesGroup(getCol(col))) {
-        return true;
-      }
+  template <size_t BOX> auto BasicSudoku<BOX>::solveStep() -> bool {
+    if constexpr (Tracer::ENABLED) {
+      spdlog::trace("SolveStep");
     }
-    for (size_t row = 0; row < ROWS; row += 3) {
-      for (size_t col = 0; col < COLS; col += 3) {
-        if (solveRuleHiddenTuplesGroup(getBlock(row, col))) {
-          return true;
-        }
+
+    beginStep();
+    bool updated = applyRules();
+    endStep();
+
+    return updated;
+  }
+
+  // The unsolved cell with the fewest candidates
+  template <size_t BOX> auto BasicSudoku<BOX>::findBranchCell() const -> size_t {
+    size_t branchCell = 0;
+    int branchCount = static_cast<int>(SIZE) + 1;
+    for (size_t cell = 0; cell < CELLS && branchCount > 2; cell++) {
+      int count = candidateCount(board.getCell(cell));
+      if (count > 1 && count < branchCount) {
+        branchCell = cell;
+        branchCount = count;
       }
     }
-    return false;
+    return branchCell;
   }
 
-  auto Sudoku::solveRuleXWingCells(size_t row0, size_t row1, size_t col0, size_t col1) -> bool {
-    Group candidateCells;
-    candidateCells.add(state.back().getCell(row0, col0));
-    candidateCells.add(state.back().getCell(row0, col1));
-    candidateCells.add(state.back().getCell(row1, col0));
-    candidateCells.add(state.back().getCell(row1, col1));
-    // Get all candidates in group
-    std::set<int> candidates;
-    for (const auto& cell : candidateCells) {
-      if (cell.candidateCount() == 1) {
-        return false;
-      }
-      for (auto candidate : cell.toVector()) {
-        candidates.insert(candidate);
-      }
-    }
-
-    for (auto candidate : candidates) {
-      if (candidateCells[0].hasCandidate(candidate)
-          && candidateCells[1].hasCandidate(   candidate)
-          && candidateCells[2].hasCandidate(   candidate)
-          && candidateCells[3].hasCandidate(   candidate)) {
-        spdlog::trace("{} shared amoungst ({},{}) ({},{}), ({},{}), ({},{})", candidate, row0, col0,
-                      row0, col1, row1, col0, row1, col1);
-        bool unique;
-        bool others;
-
-        // Check rows
-        unique = true;
-        others = false;
-        // Check that other cells in row dont contain candidate
-        for (auto row : {getRow(row0), getRow(row1)}) {
-          for (auto cell : row) {
-            if (cell.hasCandidate(candidate)
-                && cell.col != col0 && cell.col != col1) {
-              unique = false;
-            }
-          }
-        }
-        // Check that other cells in rows contain candidate
-        for (auto col : {getCol(col0), getCol(col1)}) {
-          for (auto cell : col) {
-            if (cell.hasCandidate(candidate)
-                && cell.row != row0 && cell.row != row1) {
-              others = true;
-            }
-          }
-        }
-        if (unique && others) {
-          spdlog::debug("\n{}", toDebugTable());
-          spdlog::debug("{} is unique across rows for ({},{}) ({},{}), ({},{}), ({},{})", candidate,
-                        row0, col0, row0, col1, row1, col0, row1, col1);
-          for (auto col : {getCol(col0), getCol(col1)}) {
-            for (auto cell : col) {
-              if (cell.hasCandidate(candidate)
-                  && cell.row != row0 && cell.row != row1) {
-                cell.removeCandidate(candidate);
-              }
-            }
-          }
-          spdlog::debug("\n{}", toDebugTable());
-          return true;
-        }
+  template <size_t BOX> auto BasicSudoku<BOX>::searchNode() -> bool {
+    solveStats[Rule::Search].invoked++;
+    while (board.isConsistent() && applyRules()) {
+    }
+    if (!board.isConsistent()) {
+      return false;
+    }
+    if (solved()) {
+      return true;
+    }
 
-        // Check columns
-        unique = true;
-        others = false;
-        // Check that other cells in column dont contain candidate
-        for (auto col : {getCol(col0), getCol(col1)}) {
-          for (auto cell : col) {
-            if (cell.hasCandidate(candidate)
-                && cell.row != row0 && cell.row != row1) {
-              unique = false;
-            }
-          }
-        }
-        // Check that other cells in row dont contain candidate
-        for (auto row : {getRow(row0), getRow(row1)}) {
-          for (auto& cell : row) {
-            if (cell.hasCandidate(candidate)
-                && cell.col != col0 && cell.col != col1) {
-              others = true;
-            }
-          }
-        }
-        if (unique && others) {
-          spdlog::debug("\n{}", toDebugTable());
-          spdlog::debug("{} is unique across cols for ({},{}) ({},{}), ({},{}), ({},{})", candidate,
-                        row0, col0, row0, col1, row1, col0, row1, col1);
-          for (auto row : {getRow(row0), getRow(row1)}) {
-            for (auto& cell : row) {
-              if (cell.hasCandidate(candidate)
-                  && cell.col != col0 && cell.col != col1) {
-                cell.removeCandidate(candidate);
-              }
-            }
-          }
-          spdlog::debug("\n{}", toDebugTable());
-          return true;
-        }
+    size_t branchCell = findBranchCell();
+    Candidates choices = board.getCell(branchCell);
+    size_t mark = board.changeLog->size();
+    for (int value = 1; value <= static_cast<int>(SIZE); value++) {
+      if (!hasDigit(choices, value)) {
+        continue;
+      }
+      if constexpr (Tracer::ENABLED) {
+        spdlog::debug("Search: Trying {} in ({},{})", value, Board::rowOf(branchCell),
+                      Board::colOf(branchCell));
       }
+      solveStats[Rule::Search].fired++;
+      Candidates digit = digitMask<Candidates>(value);
+      tracer.emit(TraceEvent::Kind::Guessed, Rule::Search, branchCell, digit);
+      board.keepOnly(branchCell, digit);
+      boardVersion++;
+      if (searchNode()) {
+        return true;
+      }
+      board.rewind(mark);
+      boardVersion++;
+      tracer.emit(TraceEvent::Kind::Backtracked, Rule::Search, branchCell, digit);
     }
-
     return false;
   }
 
-  auto Sudoku::solveRuleXWing() -> bool {
-    spdlog::trace("solveRuleXWing");
-    for (size_t row0 = 0; row0 < ROWS; row0++) {
-      for (size_t col0 = 0; col0 < COLS; col0++) {
-        for (size_t row1 = row0 + 1; row1 < ROWS; row1++) {
-          for (size_t col1 = col0 + 1; col1 < COLS; col1++) {
-            if (row0 / 3 != row1 / 3 || col0 / 3 != col1 / 3) {
-              if (solveRuleXWingCells(row0, row1, col0, col1)) {
-                return true;
-              }
-            }
-          }
-        }
+  // Like searchNode(), but tries every branch until limit solutions are found
+  template <size_t BOX>
+  void BasicSudoku<BOX>::countNode(size_t limit, std::span<Board> solutions, size_t& found) {
+    // The rules only remove candidates, so they stall on a broken board too, and checking it
+    // once instead of after every rule pays off over the many nodes of a count
+    while (applyRules()) {
+    }
+    if (!board.isConsistent()) {
+      return;
+    }
+    if (solved()) {
+      if (found < solutions.size()) {
+        solutions[found] = board;
+        solutions[found].changeLog = nullptr;
       }
+      found++;
+      return;
     }
-    return false;
-  }
 
-  auto Sudoku::solveStep() -> bool {
-    spdlog::trace("SolveStep");
-    using Step = bool (Sudoku::*)();
+    size_t branchCell = findBranchCell();
+    Candidates choices = board.getCell(branchCell);
+    size_t mark = board.changeLog->size();
+    for (int value = 1; value <= static_cast<int>(SIZE) && found < limit; value++) {
+      if (!hasDigit(choices, value)) {
+        continue;
+      }
+      board.keepOnly(branchCell, digitMask<Candidates>(value));
+      boardVersion++;
+      countNode(limit, solutions, found);
+      board.rewind(mark);
+      boardVersion++;
+    }
+  }
 
-    std::vector<Step> rules
-        = {&Sudoku::solveRulePenciling, &Sudoku::solveRulePointing, &Sudoku::solveRuleHiddenPairs,
-           &Sudoku::solveRuleHiddenTuples, &Sudoku::solveRuleXWing};
+  template <size_t BOX>
+  auto BasicSudoku<BOX>::countSolutions(size_t limit, std::span<Board> solutions) const
+      -> size_t {
+    if (limit == 0) {
+      return 0;
+    }
+    // A scratch game without history, trace sink or rule timing, kept per thread so repeated
+    // counts allocate nothing once its change log has grown. The singles are the cheapest rules
+    // per node.
+    static thread_local std::optional<BasicSudoku> counter;
+    static thread_local ChangeLog searchChanges;
+    if (counter) {
+      counter->load(board);
+    } else {
+      counter.emplace(board, History::None);
+      counter->setRules(SINGLES_RULES);
+      counter->setSweep(Sweep::All);
+      counter->timeRules = false;
+    }
+    searchChanges.clear();
+    counter->board.changeLog = &searchChanges;
+    size_t found = 0;
+    counter->countNode(limit, solutions, found);
+    return found;
+  }
 
-    state.push_back(state.back());
+  template <size_t BOX> auto BasicSudoku<BOX>::solve(SolveMode mode) -> bool {
+    while (solveStep()) {
+    }
+    if (solved() || mode == SolveMode::Logic) {
+      return solved();
+    }
 
-    return std::ranges::any_of(rules, [this](const Step& rule) { return (this->*rule)(); });
+    if constexpr (Tracer::ENABLED) {
+      spdlog::debug("Rules stalled, searching");
+    }
+    beginStep();
+    // Search needs a log to backtrack even when no history is kept
+    ChangeLog searchChanges;
+    if (board.changeLog == nullptr) {
+      board.changeLog = &searchChanges;
+    }
+    size_t mark = board.changeLog->size();
+    auto start = std::chrono::steady_clock::now();
+    bool found = searchNode();
+    solveStats[Rule::Search].time += std::chrono::steady_clock::now() - start;
+    if (!found) {
+      board.rewind(mark);
+      boardVersion++;
+    }
+    endStep();
+    return found;
   }
 
+  template class BasicSudoku<2>;
+  template class BasicSudoku<3>;
+  template class BasicSudoku<4>;
+  template class BasicSudoku<5>;
+
 }  // namespace sudoku
@@ -1,17 +1,28 @@
 #include <spdlog/sinks/basic_file_sink.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
 #include <spdlog/spdlog.h>
+#include <sudoku/batch.h>
+#include <sudoku/generator.h>
+#include <sudoku/io.h>
+#include <sudoku/packed.h>
+#include <sudoku/reader.h>
+#include <sudoku/stats.h>
 #include <sudoku/sudoku.h>
 #include <sudoku/version.h>
 
+#include <array>
 #include <cxxopts.hpp>
+#include <cstdint>
 #include <iostream>
+#include <optional>
 #include <print>
 #include <string>
+#include <tuple>
 #include <unordered_map>
 
 void init_logging() {
-  auto console_sink = std::make_shared<spdlog::sinks::stdout_color_sink_mt>();
+  // stdout is reserved for boards and solutions
+  auto console_sink = std::make_shared<spdlog::sinks::stderr_color_sink_mt>();
   console_sink->set_level(spdlog::level::info);
 
   auto file_sink = std::make_shared<spdlog::sinks::basic_file_sink_mt>("sudoku.log", true);
@@ -27,20 +38,204 @@ void init_logging() {
   spdlog::flush_on(spdlog::level::info);
 }
 
+// Solve step by step, printing the board before every step
+template <typename Game> void solveWithSteps(Game& game) {
+  bool updated = true;
+  int step = 0;
+  while (updated) {
+    // while (updated && step < 1) {
+    std::cout << "Step: " << ++step << std::endl << std::flush;
+    std::cout << game.toTable() << std::flush;
+    // std::cout << game.toDebug() << std::flush;
+    updated = game.solveStep();
+  }
+}
+
+// Solve a puzzle given on the command line step by step
+template <size_t BOX> void solveArgument(const std::string& puzzle,
+                                         const std::vector<sudoku::Rule>& rules,
+                                         sudoku::SolveStats& stats) {
+  sudoku::BasicSudoku<BOX> game(puzzle);
+  game.setRules(rules);
+  std::cout << game.toString() << std::endl;
+  solveWithSteps(game);
+  stats += game.getSolveStats();
+  std::println("Steps taken: {}", game.stepsTaken());
+}
+
+// Solve every puzzle of a file, writing one solution per line
+void solveFile(const std::string& filename, bool printSteps, const std::vector<sudoku::Rule>& rules,
+               sudoku::SolveStats& stats) {
+  sudoku::PuzzleReader reader(filename);
+  std::array<char, sudoku::CELLS + 1> line{};
+  while (auto puzzle = reader.next()) {
+    try {
+      sudoku::Sudoku game(*puzzle, sudoku::History::None);
+      game.setRules(rules);
+      if (printSteps) {
+        solveWithSteps(game);
+      } else {
+        game.setSweep(sudoku::Sweep::All);
+      }
+      game.solve(sudoku::SolveMode::LogicThenSearch);
+      stats += game.getSolveStats();
+      size_t length = game.writeString(line);
+      line[length] = '\n';
+      std::cout.write(line.data(), static_cast<std::streamsize>(length + 1));
+    } catch (const std::invalid_argument& e) {
+      std::cerr << filename << ":" << reader.lineNumber() << ": " << e.what() << '\n';
+      // Keep output lines aligned with input puzzles
+      std::cout << '\n';
+    }
+  }
+  std::cout << std::flush;
+}
+
+// Write the solutions of a block, one per line, with a single write
+void writeSolutions(const std::vector<sudoku::BatchResult>& results, std::string& output) {
+  output.clear();
+  for (const auto& result : results) {
+    output += result.solution;
+    output += '\n';
+  }
+  std::cout.write(output.data(), static_cast<std::streamsize>(output.size()));
+}
+
+// Solve a file on several threads, one block of puzzles at a time
+void solveFileParallel(const std::string& filename, size_t threads,
+                       const std::vector<sudoku::Rule>& rules, sudoku::SolveStats& stats) {
+  const size_t blockSize = 1 << 16;
+  sudoku::PuzzleReader reader(filename);
+  sudoku::BatchOptions batchOptions;
+  batchOptions.threads = threads;
+  batchOptions.rules = rules;
+
+  std::string block;
+  std::vector<size_t> offsets;
+  std::vector<size_t> lineNumbers;
+  std::vector<std::string_view> puzzles;
+  std::string output;
+
+  auto solveBlock = [&]() {
+    puzzles.clear();
+    for (size_t i = 0; i < offsets.size(); i++) {
+      size_t end = i + 1 < offsets.size() ? offsets[i + 1] : block.size();
+      puzzles.emplace_back(block.data() + offsets[i], end - offsets[i]);
+    }
+    auto results = sudoku::solveBatch(puzzles, batchOptions, &stats);
+    for (size_t i = 0; i < results.size(); i++) {
+      if (!results[i].error.empty()) {
+        std::cerr << filename << ":" << lineNumbers[i] << ": " << results[i].error << '\n';
+      }
+    }
+    writeSolutions(results, output);
+    block.clear();
+    offsets.clear();
+    lineNumbers.clear();
+  };
+
+  while (auto puzzle = reader.next()) {
+    offsets.push_back(block.size());
+    lineNumbers.push_back(reader.lineNumber());
+    block.append(*puzzle);
+    if (offsets.size() == blockSize) {
+      solveBlock();
+    }
+  }
+  solveBlock();
+  std::cout << std::flush;
+}
+
+// Solve a packed corpus, the workers decode one block of records at a time from the mapping
+void solvePackedFile(const std::string& filename, size_t threads,
+                     const std::vector<sudoku::Rule>& rules, sudoku::SolveStats& stats) {
+  const size_t blockSize = 1 << 16;
+  sudoku::PackedReader corpus(filename);
+  sudoku::BatchOptions batchOptions;
+  batchOptions.threads = threads;
+  batchOptions.rules = rules;
+  std::string output;
+
+  for (size_t first = 0; first < corpus.size(); first += blockSize) {
+    auto results = sudoku::solveBatch(corpus, first, blockSize, batchOptions, &stats);
+    for (size_t i = 0; i < results.size(); i++) {
+      if (!results[i].error.empty()) {
+        std::cerr << filename << ": record " << first + i << ": " << results[i].error << '\n';
+      }
+    }
+    writeSolutions(results, output);
+  }
+  std::cout << std::flush;
+}
+
+// Generate puzzles to stdout, one per line, or into a packed file
+void generate(size_t count, const sudoku::GeneratorOptions& generatorOptions,
+              const std::string& packPath) {
+  auto puzzles = sudoku::generatePuzzles(count, generatorOptions);
+  std::optional<sudoku::PackedWriter> writer;
+  if (!packPath.empty()) {
+    writer.emplace(packPath);
+  }
+  std::array<char, sudoku::CELLS + 1> line{};
+  size_t missing = 0;
+  for (const auto& generated : puzzles) {
+    if (!generated) {
+      missing++;
+    } else if (writer) {
+      writer->write(generated->puzzle);
+    } else {
+      *sudoku::formatBoard(generated->puzzle, line.data()) = '\n';
+      std::cout.write(line.data(), static_cast<std::streamsize>(line.size()));
+    }
+  }
+  if (writer) {
+    writer->close();
+  }
+  std::cout << std::flush;
+  if (missing != 0) {
+    spdlog::warn("{} of {} puzzles missed the grade band within {} grids each", missing, count,
+                 generatorOptions.attempts);
+  }
+}
+
 auto main(int argc, char** argv) -> int {
   init_logging();
   spdlog::info("Hello, Sudoku world!");
   cxxopts::Options options(*argv, "A Sudoku Solver");
 
   std::string filename;
+  size_t threads = 1;
+  std::string statsFormat;
+  std::string rulesSpec = "all";
+  std::string packPath;
+  std::string unpackPath;
+  size_t generateCount = 0;
+  std::uint64_t seed = 0;
+  std::string gradeSpec = "any";
   std::vector<std::string> sudokus;
+  sudoku::SolveStats stats;
 
   // clang-format off
   options.add_options()
     ("h,help", "Show help")
     ("v,version", "Print the current version number")
-    ("f,file", "File of sudokus to solve, one per line", cxxopts::value(filename))
-    ("sudokus", "Sudokus to solve", cxxopts::value(sudokus))
+    ("f,file", "File of sudokus to solve, one per line or packed", cxxopts::value(filename))
+    ("pack", "Convert the text file to the packed format at this path instead of solving",
+     cxxopts::value(packPath))
+    ("unpack", "Convert the packed file to text at this path instead of solving",
+     cxxopts::value(unpackPath))
+    ("g,generate", "Generate this many puzzles, to stdout or the file given with --pack",
+     cxxopts::value(generateCount))
+    ("seed", "Seed of the generator, the same seed gives the same puzzles", cxxopts::value(seed))
+    ("grade", "Hardest rule generated puzzles need: any, a rule or a band like pointing:search",
+     cxxopts::value(gradeSpec))
+    ("s,steps", "Print the board before every step when solving a text file, needs -t 1")
+    ("t,threads", "Threads solving or generating, 0 for one per core", cxxopts::value(threads))
+    ("stats", "Print rule counters to stderr when done, as text or json",
+     cxxopts::value(statsFormat)->implicit_value("text"))
+    ("r,rules", "Rules to apply in order: all, singles or a list like penciling,hidden-singles",
+     cxxopts::value(rulesSpec))
+    ("sudokus", "Sudokus to solve, 4x4, 9x9, 16x16 or 25x25 by length", cxxopts::value(sudokus))
   ;
   // clang-format on
   options.parse_positional({"sudokus"});
@@ -58,33 +253,92 @@ auto main(int argc, char** argv) -> int {
     return 0;
   }
 
-  for (uint i = 0; i < sudokus.size(); i++) {
+  if (!statsFormat.empty() && statsFormat != "text" && statsFormat != "json") {
+    std::cerr << "Unknown stats format '" << statsFormat << "', expected text or json" << std::endl;
+    return 1;
+  }
+
+  std::vector<sudoku::Rule> rules;
+  try {
+    rules = sudoku::parseRules(rulesSpec);
+  } catch (const std::invalid_argument& e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+
+  // Logging every step of thousands of puzzles would cost more than solving them
+  bool converting = !packPath.empty() || !unpackPath.empty();
+  if (generateCount != 0 || (!filename.empty() && !converting)) {
+    spdlog::set_level(spdlog::level::warn);
+  }
+
+  if (generateCount != 0) {
     try {
-      sudoku::Sudoku game = sudoku::Sudoku(sudokus[i]);
-      // std::cout << game << std::endl;
-      std::cout << game.toString() << std::endl;
-
-      // std::cout << game.toTable() << std::flush;
-
-      // std::cout << game.toDebug() << std::flush;
-
-      bool updated = true;
-      int step = 0;
-      while (updated) {
-        // while (updated && step < 1) {
-        std::cout << "Step: " << ++step << std::endl << std::flush;
-        std::cout << game.toTable() << std::flush;
-        // std::cout << game.toDebug() << std::flush;
-        updated = game.solveStep();
-      }
+      sudoku::GeneratorOptions generatorOptions;
+      generatorOptions.seed = seed;
+      generatorOptions.threads = threads;
+      std::tie(generatorOptions.minGrade, generatorOptions.maxGrade)
+          = sudoku::parseGradeBand(gradeSpec);
+      generate(generateCount, generatorOptions, packPath);
+    } catch (const std::exception& e) {
+      std::cerr << e.what() << std::endl;
+      return 1;
+    }
+    return 0;
+  }
 
-      std::println("Steps taken: {}", game.stepsTaken());
+  if (!filename.empty()) {
+    bool printSteps = result["steps"].as<bool>();
+    try {
+      if (!packPath.empty()) {
+        size_t count = sudoku::packTextFile(filename, packPath);
+        spdlog::info("Packed {} puzzles into {}", count, packPath);
+      } else if (!unpackPath.empty()) {
+        size_t count = sudoku::unpackToText(filename, unpackPath);
+        spdlog::info("Unpacked {} puzzles into {}", count, unpackPath);
+      } else if (printSteps && (threads != 1 || sudoku::isPackedFile(filename))) {
+        // Only the single threaded text path solves puzzles one step at a time
+        throw std::runtime_error("--steps needs a text file and --threads 1");
+      } else if (sudoku::isPackedFile(filename)) {
+        solvePackedFile(filename, threads, rules, stats);
+      } else if (threads == 1) {
+        solveFile(filename, printSteps, rules, stats);
+      } else {
+        solveFileParallel(filename, threads, rules, stats);
+      }
+    } catch (const std::runtime_error& e) {
+      std::cerr << e.what() << std::endl;
+      return 1;
+    }
+  }
 
+  for (uint i = 0; i < sudokus.size(); i++) {
+    try {
+      // The board size follows from the length, 9x9 reports its own errors
+      switch (sudokus[i].size()) {
+        case 16:
+          solveArgument<2>(sudokus[i], rules, stats);
+          break;
+        case 256:
+          solveArgument<4>(sudokus[i], rules, stats);
+          break;
+        case 625:
+          solveArgument<5>(sudokus[i], rules, stats);
+          break;
+        default:
+          solveArgument<3>(sudokus[i], rules, stats);
+      }
     } catch (const std::invalid_argument& e) {
       std::cerr << e.what() << std::endl;
       continue;
     }
   }
 
+  if (statsFormat == "text") {
+    std::cerr << sudoku::statsToText(stats);
+  } else if (statsFormat == "json") {
+    std::cerr << sudoku::statsToJson(stats) << std::endl;
+  }
+
   return 0;
 }
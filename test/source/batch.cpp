@@ -0,0 +1,83 @@
+#include <doctest/doctest.h>
+#include <sudoku/batch.h>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+TEST_CASE("Batch") {
+  using namespace sudoku;
+
+  const std::string_view simple
+      = "53..7....6..195....98....6.8...6...34..8.3..17...2...6.6....28....419..5....8..79";
+  const std::string_view hardest
+      = "8..........36......7..9.2...5...7.......457.....1...3...1....68..85...1..9....4..";
+  const std::string_view simpleSolution
+      = "534678912672195348198342567859761423426853791713924856961537284287419635345286179";
+  const std::string_view hardestSolution
+      = "812753649943682175675491283154237896369845721287169534521974368438526917796318452";
+
+  // Enough puzzles for every worker to steal, with a broken one in the middle
+  std::vector<std::string_view> puzzles;
+  for (size_t i = 0; i < 64; i++) {
+    puzzles.push_back(i % 2 == 0 ? simple : hardest);
+  }
+  puzzles[17] = "not a sudoku";
+
+  for (auto engine : {Engine::Rules, Engine::DancingLinks, Engine::Lanes}) {
+    BatchOptions options;
+    options.threads = 4;
+    options.engine = engine;
+    auto results = solveBatch(puzzles, options);
+    REQUIRE(results.size() == puzzles.size());
+    for (size_t i = 0; i < results.size(); i++) {
+      if (i == 17) {
+        CHECK(!results[i].solved);
+        CHECK(!results[i].error.empty());
+        continue;
+      }
+      CHECK(results[i].solved);
+      CHECK(results[i].error.empty());
+      CHECK(results[i].solution == (i % 2 == 0 ? simpleSolution : hardestSolution));
+    }
+  }
+
+  // Bad rules fail the puzzles that reach the game, for lanes those that stall, mid-run and in
+  // the final flush alike
+  std::vector<std::string_view> many(130, hardest);
+  many[3] = simple;
+  for (auto engine : {Engine::Rules, Engine::Lanes}) {
+    BatchOptions options;
+    options.threads = 1;
+    options.engine = engine;
+    options.rules = {Rule::Penciling, Rule::Penciling};
+    auto results = solveBatch(many, options);
+    REQUIRE(results.size() == many.size());
+    CHECK(results[3].solved == (engine == Engine::Lanes));
+    for (size_t i = 0; i < results.size(); i++) {
+      if (i != 3) {
+        CHECK(!results[i].solved);
+        CHECK(results[i].error.find("repeated") != std::string::npos);
+      }
+    }
+  }
+
+  // Counting tells unique puzzles from open ones
+  const std::string open = "." + std::string(hardest.substr(1));
+  const std::vector<std::string_view> counted = {simple, hardest, open};
+  for (auto engine : {Engine::Rules, Engine::DancingLinks}) {
+    BatchOptions options;
+    options.threads = 2;
+    options.engine = engine;
+    options.countLimit = 2;
+    auto results = solveBatch(counted, options);
+    REQUIRE(results.size() == counted.size());
+    CHECK(results[0].solutions == 1);
+    CHECK(results[0].solution == simpleSolution);
+    CHECK(results[1].solutions == 1);
+    CHECK(results[2].solutions == 2);
+    CHECK(results[2].solved);
+  }
+
+  CHECK(solveBatch({}).empty());
+}
@@ -0,0 +1,37 @@
+#include <doctest/doctest.h>
+#include <sudoku/dlx.h>
+#include <sudoku/io.h>
+
+#include <array>
+#include <memory>
+
+TEST_CASE("Dancing Links") {
+  using namespace sudoku;
+
+  auto solver = std::make_unique<DancingLinks>();
+  std::array<Board, 2> solutions;
+
+  // World's Hardest Sudoku, unique
+  Board hardest = parseBoard(
+      "8..........36......7..9.2...5...7.......457.....1...3...1....68..85...1..9....4..");
+  CHECK(solver->solve(hardest, 2, solutions) == 1);
+  CHECK(boardToString(solutions[0])
+        == "812753649943682175675491283154237896369845721287169534521974368438526917796318452");
+
+  // Many solutions, the limit stops the enumeration
+  Board manySolutions = parseBoard(
+      "1....7..9....3..5...........2..1..8...........5..9..3...........4..8....7..2....6");
+  CHECK(solver->solve(manySolutions, 10, solutions) == 10);
+  CHECK(boardToString(solutions[0]) != boardToString(solutions[1]));
+  CHECK(solver->solve(manySolutions, 1) == 1);
+
+  // Clashing givens
+  Board clash = parseBoard(
+      "11...............................................................................");
+  CHECK(solver->solve(clash, 2) == 0);
+
+  // The links are restored after every solve
+  CHECK(solver->solve(hardest, 2, solutions) == 1);
+  CHECK(boardToString(solutions[0])
+        == "812753649943682175675491283154237896369845721287169534521974368438526917796318452");
+}
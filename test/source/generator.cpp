@@ -0,0 +1,65 @@
+#include <doctest/doctest.h>
+#include <sudoku/generator.h>
+#include <sudoku/io.h>
+#include <sudoku/sudoku.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+TEST_CASE("Generator") {
+  using namespace sudoku;
+
+  GeneratorOptions options;
+  options.seed = 42;
+  options.threads = 1;
+  auto single = generatePuzzles(6, options);
+  options.threads = 3;
+  auto parallel = generatePuzzles(6, options);
+  REQUIRE(single.size() == 6);
+  REQUIRE(parallel.size() == 6);
+
+  for (size_t i = 0; i < single.size(); i++) {
+    REQUIRE(single[i].has_value());
+    REQUIRE(parallel[i].has_value());
+    // Same seed, same puzzles, whatever the threads
+    CHECK(boardToString(single[i]->puzzle) == boardToString(parallel[i]->puzzle));
+
+    const GeneratedPuzzle& generated = *single[i];
+    Sudoku game(generated.puzzle);
+    Board solution;
+    CHECK(game.countSolutions(2, {&solution, 1}) == 1);
+    CHECK(boardToString(solution) == boardToString(generated.solution));
+    CHECK(gradePuzzle(generated.puzzle) == generated.grade);
+
+    std::string puzzle = boardToString(generated.puzzle);
+    CHECK(static_cast<size_t>(std::ranges::count(puzzle, '.')) == CELLS - generated.clues);
+    // Clues come in pairs mirrored through the center
+    for (size_t cell = 0; cell < CELLS; cell++) {
+      CHECK((puzzle[cell] == '.') == (puzzle[CELLS - 1 - cell] == '.'));
+    }
+  }
+  CHECK(boardToString(single[0]->puzzle) != boardToString(single[1]->puzzle));
+
+  // Puzzles for beginners stay within the singles
+  options.maxGrade = Rule::HiddenSingles;
+  auto easy = generatePuzzle(7, options);
+  REQUIRE(easy.has_value());
+  CHECK(easy->grade <= Rule::HiddenSingles);
+  CHECK(Sudoku(easy->puzzle).solve());
+}
+
+TEST_CASE("Grade bands") {
+  using namespace sudoku;
+
+  CHECK(parseGradeBand("any") == std::pair{Rule::Penciling, Rule::Search});
+  CHECK(parseGradeBand("Pointing") == std::pair{Rule::Pointing, Rule::Pointing});
+  CHECK(parseGradeBand("hidden-singles:search") == std::pair{Rule::HiddenSingles, Rule::Search});
+  CHECK_THROWS_AS(parseGradeBand("fish:pointing"), std::invalid_argument);
+  CHECK_THROWS_AS(parseGradeBand("swordfish"), std::invalid_argument);
+
+  const std::string hardest
+      = "8..........36......7..9.2...5...7.......457.....1...3...1....68..85...1..9....4..";
+  CHECK(gradePuzzle(parseBoard(hardest)) == Rule::Search);
+}
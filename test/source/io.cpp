@@ -0,0 +1,100 @@
+#include <doctest/doctest.h>
+#include <sudoku/io.h>
+
+#include <array>
+#include <iterator>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+TEST_CASE("Parse formats") {
+  using namespace sudoku;
+
+  const std::string puzzle
+      = "53..7....6..195....98....6.8...6...34..8.3..17...2...6.6....28....419..5....8..79";
+  Board expected = parseBoard(puzzle);
+  Board board;
+
+  // Tables as printed, with '0' blanks and comments
+  CHECK(tryParseBoard(boardToTable(expected), board).ok());
+  CHECK(boardToString(board) == puzzle);
+
+  std::string zeros = puzzle;
+  for (char& c : zeros) {
+    c = c == '.' ? '0' : c;
+  }
+  CHECK(tryParseBoard(zeros + "  # from the newspaper\n", board).ok());
+  CHECK(boardToString(board) == puzzle);
+
+  const std::string_view grid
+      = "# header\n"
+        "5 3 0 | 0 7 0 | 0 0 0\n"
+        "6 0 0 | 1 9 5 | 0 0 0  # row two\n"
+        "0 9 8 | 0 0 0 | 0 6 0\n"
+        "------+-------+------\n"
+        "8 0 0 | 0 6 0 | 0 0 3\n"
+        "4 0 0 | 8 0 3 | 0 0 1\n"
+        "7 0 0 | 0 2 0 | 0 0 6\n"
+        "------+-------+------\n"
+        "0 6 0 | 0 0 0 | 2 8 0\n"
+        "0 0 0 | 4 1 9 | 0 0 5\n"
+        "0 0 0 | 0 8 0 | 0 7 9\n";
+  CHECK(tryParseBoard(grid, board).ok());
+  CHECK(boardToString(board) == puzzle);
+}
+
+TEST_CASE("Parse errors") {
+  using namespace sudoku;
+
+  const std::string puzzle
+      = "53..7....6..195....98....6.8...6...34..8.3..17...2...6.6....28....419..5....8..79";
+  Board board;
+
+  ParseResult result = tryParseBoard(puzzle.substr(0, 80), board);
+  CHECK(result.status == ParseStatus::TooFewCells);
+  CHECK(result.cells == 80);
+
+  result = tryParseBoard(puzzle + "\n1", board);
+  CHECK(result.status == ParseStatus::TooManyCells);
+  CHECK(result.offset == 82);
+
+  std::string bad = puzzle;
+  bad[40] = 'x';
+  result = tryParseBoard(bad, board);
+  CHECK(result.status == ParseStatus::InvalidCharacter);
+  CHECK(result.offset == 40);
+  CHECK(result.character == 'x');
+
+  // Digits past the board size are invalid as well
+  BasicBoard<2> small;
+  result = tryParseBoard(std::string_view("1234 3412 2143 4325"), small);
+  CHECK(result.status == ParseStatus::InvalidCharacter);
+  CHECK(result.offset == 18);
+  CHECK_THROWS_AS(parseBoard(bad), std::invalid_argument);
+}
+
+TEST_CASE("Format into buffers") {
+  using namespace sudoku;
+
+  const std::string puzzle
+      = "53..7....6..195....98....6.8...6...34..8.3..17...2...6.6....28....419..5....8..79";
+  Board board = parseBoard(puzzle);
+
+  std::array<char, CELLS + 1> buffer{};
+  CHECK(writeBoard(board, buffer) == CELLS);
+  CHECK(std::string_view(buffer.data(), CELLS) == puzzle);
+  CHECK(writeBoard(board, std::span(buffer).first(CELLS - 1)) == 0);
+
+  std::string table;
+  formatTable(board, std::back_inserter(table));
+  CHECK(table == boardToTable(board));
+  CHECK(table.size() == TABLE_SIZE<3>);
+  CHECK(boardToTable(BasicBoard<2>{}).size() == TABLE_SIZE<2>);
+  CHECK(boardToTable(BasicBoard<4>{}).size() == TABLE_SIZE<4>);
+
+  // Appends behind what is already there
+  std::string lines = "# solutions\n";
+  *formatBoard(board, std::back_inserter(lines)) = '\n';
+  CHECK(lines == "# solutions\n" + puzzle + "\n");
+}
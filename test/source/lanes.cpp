@@ -0,0 +1,51 @@
+#include <doctest/doctest.h>
+#include <sudoku/io.h>
+#include <sudoku/lanes.h>
+
+#include <string>
+#include <vector>
+
+TEST_CASE("Lane solver") {
+  using namespace sudoku;
+
+  // More puzzles than lanes so lanes get refilled
+  std::vector<Board> puzzles;
+  for (size_t i = 0; i < 2 * LaneSolver::LANES + 3; i++) {
+    switch (i % 3) {
+      case 0:
+        puzzles.push_back(parseBoard(
+            "53..7....6..195....98....6.8...6...34..8.3..17...2...6.6....28....419..5....8..79"));
+        break;
+      case 1:
+        puzzles.push_back(parseBoard(
+            "8..........36......7..9.2...5...7.......457.....1...3...1....68..85...1..9....4.."));
+        break;
+      default:
+        puzzles.push_back(parseBoard(
+            "11..............................................................................."));
+        break;
+    }
+  }
+
+  const std::string solution
+      = "534678912672195348198342567859761423426853791713924856961537284287419635345286179";
+  std::vector<Board> results(puzzles.size());
+  std::vector<LaneStatus> status(puzzles.size());
+  LaneSolver solver;
+  solver.solve(puzzles, results, status);
+
+  for (size_t i = 0; i < puzzles.size(); i++) {
+    switch (i % 3) {
+      case 0:
+        CHECK(status[i] == LaneStatus::Solved);
+        CHECK(boardToString(results[i]) == solution);
+        break;
+      case 1:
+        CHECK(status[i] == LaneStatus::Stalled);
+        break;
+      default:
+        CHECK(status[i] == LaneStatus::Invalid);
+        break;
+    }
+  }
+}
@@ -0,0 +1,99 @@
+#include <doctest/doctest.h>
+#include <sudoku/batch.h>
+#include <sudoku/io.h>
+#include <sudoku/packed.h>
+
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+TEST_CASE("Packed corpus") {
+  using namespace sudoku;
+
+  const std::string simple
+      = "53..7....6..195....98....6.8...6...34..8.3..17...2...6.6....28....419..5....8..79";
+  const std::string hardest
+      = "8..........36......7..9.2...5...7.......457.....1...3...1....68..85...1..9....4..";
+  const std::string hardestSolution
+      = "812753649943682175675491283154237896369845721287169534521974368438526917796318452";
+
+  const std::string textPath = "packed_test.txt";
+  const std::string packedPath = "packed_test.sdkp";
+  const std::string unpackedPath = "packed_test_unpacked.txt";
+  {
+    std::ofstream out(textPath, std::ios::binary);
+    out << "# two puzzles and a solution\n" << simple << "\n\n" << hardest << "\r\n";
+    out << hardestSolution << "\n";
+  }
+
+  CHECK(packTextFile(textPath, packedPath) == 3);
+  CHECK(isPackedFile(packedPath));
+  CHECK_FALSE(isPackedFile(textPath));
+
+  {
+    std::ifstream in(packedPath, std::ios::binary | std::ios::ate);
+    CHECK(static_cast<size_t>(in.tellg()) == PACKED_HEADER_SIZE + (3 * PACKED_RECORD_SIZE));
+  }
+
+  {
+    PackedReader corpus(packedPath);
+    REQUIRE(corpus.size() == 3);
+    // Any record, in any order
+    CHECK(boardToString(corpus.board(2)) == hardestSolution);
+    CHECK(boardToString(corpus.board(0)) == simple);
+    CHECK(boardToString(corpus.board(1)) == hardest);
+
+    BatchOptions options;
+    options.threads = 2;
+    auto results = solveBatch(corpus, 1, 10, options);
+    REQUIRE(results.size() == 2);
+    CHECK(results[0].solved);
+    CHECK(results[0].solution == hardestSolution);
+    CHECK(results[1].solution == hardestSolution);
+    CHECK(solveBatch(corpus, 5, 1).empty());
+  }
+
+  CHECK(unpackToText(packedPath, unpackedPath) == 3);
+  {
+    std::ifstream in(unpackedPath);
+    std::string line;
+    std::vector<std::string> lines;
+    while (std::getline(in, line)) {
+      lines.push_back(line);
+    }
+    CHECK(lines == std::vector<std::string>{simple, hardest, hardestSolution});
+  }
+
+  // A damaged record is an I/O error like a damaged header
+  {
+    std::fstream file(packedPath, std::ios::binary | std::ios::in | std::ios::out);
+    file.seekp(PACKED_HEADER_SIZE + PACKED_RECORD_SIZE);
+    file.put(static_cast<char>(0xFF));
+  }
+  {
+    PackedReader corpus(packedPath);
+    CHECK(boardToString(corpus.board(0)) == simple);
+    CHECK_THROWS_AS(corpus.board(1), std::runtime_error);
+  }
+  CHECK_THROWS_AS(unpackToText(packedPath, unpackedPath), std::runtime_error);
+
+  // Text is not a packed file, and a bad puzzle names its line
+  CHECK_THROWS_AS(PackedReader(textPath), std::runtime_error);
+  {
+    std::ofstream out(textPath, std::ios::binary);
+    out << simple << "\nnot a sudoku\n";
+  }
+  std::string message;
+  try {
+    packTextFile(textPath, packedPath);
+  } catch (const std::runtime_error& e) {
+    message = e.what();
+  }
+  CHECK(message.find("packed_test.txt:2:") != std::string::npos);
+
+  std::remove(textPath.c_str());
+  std::remove(packedPath.c_str());
+  std::remove(unpackedPath.c_str());
+}
@@ -0,0 +1,56 @@
+#include <doctest/doctest.h>
+#include <sudoku/propagation.h>
+
+TEST_CASE("Propagation") {
+  using namespace sudoku;
+
+  // Placing a digit removes it from exactly its 20 peers
+  Board board;
+  board.keepOnly(Board::index(4, 4), digitMask(5));
+  PropagationStats stats;
+  CHECK(propagate(board, stats));
+  CHECK(stats.solvedCells == 1);
+  CHECK(stats.peerVisits == PEERS);
+  CHECK(stats.eliminations == PEERS);
+  for (auto peer : PEER_CELLS[Board::index(4, 4)]) {
+    CHECK(!hasDigit(board.getCell(peer), 5));
+  }
+  CHECK(hasDigit(board.getCell(0, 0), 5));
+
+  // Nothing left to do on the second run
+  CHECK(!propagate(board, stats));
+  CHECK(stats.runs == 2);
+  CHECK(stats.peerVisits < stats.sweepVisits());
+}
+
+TEST_CASE("Rewind restores propagation") {
+  using namespace sudoku;
+
+  Board board;
+  ChangeLog changeLog;
+  board.changeLog = &changeLog;
+  Board initial = board;
+
+  board.keepOnly(Board::index(0, 0), digitMask(1));
+  PropagationStats stats;
+  propagate(board, stats);
+  // The placement, one record for taking it off the queue and one per peer
+  CHECK(changeLog.size() == 2 + PEERS);
+  CHECK(board.rowDigits[0] == digitMask(1));
+  CHECK(!board.hasPending());
+
+  board.rewind(0);
+  CHECK(changeLog.empty());
+  CHECK(board.cells == initial.cells);
+  CHECK(board.rowDigits == initial.rowDigits);
+  CHECK(board.colDigits == initial.colDigits);
+  CHECK(board.boxDigits == initial.boxDigits);
+  CHECK(!board.hasPending());
+
+  // Rewinding only the propagation puts the solved cell back on the queue
+  board.keepOnly(Board::index(0, 0), digitMask(1));
+  size_t mark = changeLog.size();
+  board.popPending();
+  board.rewind(mark);
+  CHECK(board.hasPending());
+}
@@ -0,0 +1,38 @@
+#include <doctest/doctest.h>
+#include <sudoku/reader.h>
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+TEST_CASE("Puzzle reader") {
+  using namespace sudoku;
+
+  const std::string path = "reader_test.txt";
+  {
+    std::ofstream out(path, std::ios::binary);
+    out << "# corpus header\n"
+        << "\n"
+        << "first line\r\n"
+        << "   \n"
+        << "  # indented comment\n"
+        << "a line that is longer than the chunk size\n"
+        << "last";
+  }
+
+  // A tiny chunk size makes lines straddle chunk boundaries
+  PuzzleReader reader(path, 8);
+  std::vector<std::string> lines;
+  std::vector<size_t> lineNumbers;
+  while (auto line = reader.next()) {
+    lines.emplace_back(*line);
+    lineNumbers.push_back(reader.lineNumber());
+  }
+  CHECK(lines == std::vector<std::string>{"first line", "a line that is longer than the chunk size",
+                                          "last"});
+  CHECK(lineNumbers == std::vector<size_t>{3, 6, 7});
+  std::remove(path.c_str());
+
+  CHECK_THROWS(PuzzleReader("does_not_exist.txt"));
+}
@@ -0,0 +1,49 @@
+#include <doctest/doctest.h>
+#include <sudoku/batch.h>
+#include <sudoku/io.h>
+#include <sudoku/stats.h>
+#include <sudoku/sudoku.h>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+TEST_CASE("Solve stats") {
+  using namespace sudoku;
+
+  const std::string puzzle
+      = "53..7....6..195....98....6.8...6...34..8.3..17...2...6.6....28....419..5....8..79";
+  Sudoku game(puzzle);
+  CHECK(game.solve());
+  const SolveStats& stats = game.getSolveStats();
+  CHECK(stats.puzzles == 1);
+
+  // Every candidate removed after parsing is counted by exactly one rule
+  Board initial = parseBoard(puzzle);
+  size_t candidates = 0;
+  for (size_t cell = 0; cell < CELLS; cell++) {
+    candidates += static_cast<size_t>(candidateCount(initial.getCell(cell)));
+  }
+  size_t eliminated = 0;
+  for (const auto& rule : stats.rules) {
+    CHECK(rule.fired <= rule.invoked);
+    eliminated += rule.eliminated;
+  }
+  CHECK(eliminated == candidates - CELLS);
+  CHECK(stats[Rule::Penciling].fired > 0);
+  CHECK(stats[Rule::Search].invoked == 0);
+
+  // Batch mode sums the workers
+  std::vector<std::string_view> puzzles(8, puzzle);
+  BatchOptions options;
+  options.threads = 3;
+  SolveStats batchStats;
+  solveBatch(puzzles, options, &batchStats);
+  CHECK(batchStats.puzzles == 8);
+  CHECK(batchStats[Rule::Penciling].eliminated == 8 * stats[Rule::Penciling].eliminated);
+
+  std::string json = statsToJson(batchStats);
+  CHECK(json.starts_with("{\"puzzles\":8,"));
+  CHECK(json.find("\"rule\":\"Fish\"") != std::string::npos);
+  CHECK(statsToText(batchStats).find("Hidden Subsets") != std::string::npos);
+}
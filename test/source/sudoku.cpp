@@ -1,9 +1,13 @@
 #include <doctest/doctest.h>
 #include <spdlog/spdlog.h>
+#include <sudoku/io.h>
 #include <sudoku/sudoku.h>
 #include <sudoku/version.h>
 
+#include <array>
+#include <cstdint>
 #include <print>
+#include <stdexcept>
 #include <string>
 
 TEST_CASE("Simple") {
@@ -52,21 +56,20 @@ TEST_CASE("World's Hardest Sudoku") {
   using namespace sudoku;
 
   spdlog::debug("World's Hardest Sudoku");
-  Sudoku game("8.........36......7..9.2...5...7.......457......1...3...1....68..85...1..9....4..");
+  Sudoku game("8..........36......7..9.2...5...7.......457.....1...3...1....68..85...1..9....4..");
   spdlog::debug("\n{}", game.toTable());
   spdlog::debug("\n{}", game.toDebugTable());
 
-  bool updated = true;
   std::cout << "Initial:\n" << game.toTable() << std::endl;
-  while (updated) {
-    updated = game.solveStep();
-  }
+  game.solve(SolveMode::LogicThenSearch);
   std::cout << "Final:\n" << game.toTable() << std::endl;
   if (!game.solved()) {
     spdlog::debug("\n{}", game.toTable());
     spdlog::debug("\n{}", game.toDebugTable());
   }
   CHECK(game.solved() == true);
+  CHECK(game.toString()
+        == "812753649943682175675491283154237896369845721287169534521974368438526917796318452");
 }
 
 TEST_CASE("17-clue Minimal") {
@@ -77,11 +80,8 @@ TEST_CASE("17-clue Minimal") {
   spdlog::debug("\n{}", game.toTable());
   spdlog::debug("\n{}", game.toDebugTable());
 
-  bool updated = true;
   std::cout << "Initial:\n" << game.toTable() << std::endl;
-  while (updated) {
-    updated = game.solveStep();
-  }
+  game.solve(SolveMode::LogicThenSearch);
   std::cout << "Final:\n" << game.toTable() << std::endl;
   if (!game.solved()) {
     spdlog::debug("\n{}", game.toTable());
@@ -113,6 +113,273 @@ TEST_CASE("X Puzzle") {
   CHECK(game.solved() == true);
 }
 
+TEST_CASE("Naked Subsets") {
+  using namespace sudoku;
+
+  // Stalls without naked subsets, which fire twice here
+  Sudoku game("9..2..58.....1..9..64.3.....3....41...2.7.........69.2689.........4...3.........5");
+  CHECK(game.solve());
+  CHECK(game.getSolveStats()[Rule::NakedSubsets].fired == 2);
+  CHECK(game.toString()
+        == "913247586278615394564839127736592418892174653451386972689753241125468739347921865");
+}
+
+TEST_CASE("Hidden Subsets") {
+  using namespace sudoku;
+
+  const std::string solution
+      = "487312695593684271126597384735849162914265837268731549851476923379128456642953718";
+  Sudoku game("48.3............71.2.......7.5....6....2..8.............1.76...3.....4......5....");
+  game.solve();
+  CHECK(game.getSolveStats()[Rule::HiddenSubsets].fired == 1);
+  // Logic stalls here, but everything it placed agrees with the solution
+  std::string partial = game.toString();
+  for (size_t cell = 0; cell < partial.size(); cell++) {
+    CHECK((partial[cell] == '.' || partial[cell] == solution[cell]));
+  }
+  CHECK(game.solve(SolveMode::LogicThenSearch));
+  CHECK(game.toString() == solution);
+}
+
+TEST_CASE("Fish") {
+  using namespace sudoku;
+
+  // A swordfish on 5 in rows fires once here
+  const std::string solution
+      = "637842591129365478548179236276538149395421687481697325762953814853714962914286753";
+  Sudoku game("..7.4...1...3.....5..1..2.6....3.14..9..2...7..1.973..7...5.8....3...9...1...6...");
+  game.solve();
+  CHECK(game.getSolveStats()[Rule::Fish].fired == 1);
+  std::string partial = game.toString();
+  for (size_t cell = 0; cell < partial.size(); cell++) {
+    CHECK((partial[cell] == '.' || partial[cell] == solution[cell]));
+  }
+}
+
+TEST_CASE("Fish without penciling") {
+  using namespace sudoku;
+
+  // Rows 3 and 6 list 1 in columns 0, 4 and 7 only, but column 7 holds it already, which leaves
+  // an X-Wing on columns 0 and 4 for a pipeline that never pencils
+  Board board = parseBoard(".......1." + std::string(72, '.'));
+  for (size_t row : {3, 6}) {
+    for (size_t col = 0; col < Board::SIZE; col++) {
+      if (col != 0 && col != 4 && col != 7) {
+        board.removeCandidates(Board::index(row, col), digitMask(1));
+      }
+    }
+  }
+  Sudoku game(board, History::None);
+  game.setRules(std::array{Rule::Fish});
+  game.solve();
+  CHECK(game.getSolveStats()[Rule::Fish].fired > 0);
+  CHECK(game.getBoard().getCell(Board::index(0, 7)) == digitMask(1));
+  CHECK_FALSE(hasDigit(game.getBoard().getCell(Board::index(1, 0)), 1));
+  CHECK_FALSE(hasDigit(game.getBoard().getCell(Board::index(8, 4)), 1));
+}
+
+TEST_CASE("Pointing") {
+  using namespace sudoku;
+
+  // One pass over the segments removes candidates in every box
+  Sudoku game(".......12..8.3...........4.12.5..........47...6.......5.7...3.....62.......1.....",
+              History::None);
+  size_t boxes = 0;
+  game.setTraceSink([&boxes](const TraceEvent& event) {
+    if (event.rule == Rule::Pointing) {
+      boxes |= size_t{1} << Board::boxOf(event.cell);
+    }
+  });
+  CHECK(game.solve());
+  CHECK(game.getSolveStats()[Rule::Pointing].fired == 1);
+  if (Tracer::ENABLED) {
+    CHECK(boxes == 0x1FF);
+  }
+}
+
+TEST_CASE("Rule pipeline") {
+  using namespace sudoku;
+
+  const std::string puzzle
+      = "9..2..58.....1..9..64.3.....3....41...2.7.........69.2689.........4...3.........5";
+  Sudoku game(puzzle, History::None);
+  CHECK(game.getRules().size() == LOGIC_RULES.size());
+
+  // Singles stall where naked subsets are needed, search finishes
+  game.setRules(SINGLES_RULES);
+  CHECK_FALSE(game.solve());
+  const SolveStats& stats = game.getSolveStats();
+  CHECK(stats[Rule::NakedSubsets].invoked == 0);
+  CHECK(stats[Rule::Pointing].invoked == 0);
+
+  // Rules that found nothing on an unchanged board are not run again
+  size_t invoked = stats[Rule::HiddenSingles].invoked;
+  CHECK_FALSE(game.solveStep());
+  CHECK(stats[Rule::HiddenSingles].invoked == invoked);
+  CHECK(game.solve(SolveMode::LogicThenSearch));
+
+  // Order is up to the caller
+  game.load(puzzle);
+  game.setRules(parseRules("penciling, naked-subsets, Hidden Singles"));
+  CHECK(game.getRules()[1] == Rule::NakedSubsets);
+  game.solve();
+  CHECK(game.getSolveStats()[Rule::NakedSubsets].fired > 0);
+
+  CHECK(parseRules("singles").size() == SINGLES_RULES.size());
+  CHECK_THROWS_AS(parseRules("penciling,fishy"), std::invalid_argument);
+  CHECK_THROWS_AS(parseRules("penciling,penciling"), std::invalid_argument);
+  CHECK_THROWS_AS(game.setRules(std::array{Rule::Search}), std::invalid_argument);
+}
+
+TEST_CASE("Hidden singles in the pipeline") {
+  using namespace sudoku;
+
+  const std::string puzzle
+      = "9..2..58.....1..9..64.3.....3....41...2.7.........69.2689.........4...3.........5";
+  // Once penciling stalls, 3 fits only cell 48 of row 5, which still has other candidates
+  const size_t cell = 48;
+  Sudoku game(puzzle, History::None);
+  game.setRules(std::array{Rule::Penciling});
+  CHECK_FALSE(game.solve());
+  CHECK(candidateCount(game.getBoard().getCell(cell)) > 1);
+  for (size_t other = 45; other < 54; other++) {
+    CHECK((other == cell) == hasDigit(game.getBoard().getCell(other), 3));
+  }
+
+  game.load(puzzle);
+  game.setRules(std::array{Rule::Penciling, Rule::HiddenSingles});
+  game.solve();
+  CHECK(game.getSolveStats()[Rule::HiddenSingles].fired > 0);
+  CHECK(game.getBoard().getCell(cell) == digitMask(3));
+}
+
+TEST_CASE("Sweep") {
+  using namespace sudoku;
+
+  const std::string puzzle
+      = "..7.4...1...3.....5..1..2.6....3.14..9..2...7..1.973..7...5.8....3...9...1...6...";
+  Sudoku first(puzzle);
+  CHECK(first.getSweep() == Sweep::First);
+  first.solve(SolveMode::LogicThenSearch);
+
+  // Same solution with fewer steps and rule passes
+  Sudoku all(puzzle);
+  all.setSweep(Sweep::All);
+  CHECK(all.solve(SolveMode::LogicThenSearch));
+  CHECK(all.toString() == first.toString());
+  CHECK(all.stepsTaken() < first.stepsTaken());
+  CHECK(all.getSolveStats()[Rule::HiddenSingles].invoked
+        < first.getSolveStats()[Rule::HiddenSingles].invoked);
+}
+
+TEST_CASE("Rewind") {
+  using namespace sudoku;
+
+  const std::string puzzle
+      = "53..7....6..195....98....6.8...6...34..8.3..17...2...6.6....28....419..5....8..79";
+  Sudoku game(puzzle);
+  std::string initial = game.toString();
+  game.solveStep();
+  std::string first = game.toString();
+  while (game.solveStep()) {
+  }
+  CHECK(game.solved());
+  size_t steps = game.stepsTaken();
+
+  game.rewind(1);
+  CHECK(game.stepsTaken() == 2);
+  CHECK(game.toString() == first);
+  game.rewind(0);
+  CHECK(game.stepsTaken() == 1);
+  CHECK(game.toString() == initial);
+  CHECK_THROWS(game.rewind(1));
+
+  // Replaying gives the same result
+  while (game.solveStep()) {
+  }
+  CHECK(game.solved());
+  CHECK(game.stepsTaken() == steps);
+
+  Sudoku lean(puzzle, History::None);
+  while (lean.solveStep()) {
+  }
+  CHECK(lean.solved());
+  CHECK(lean.toString() == game.toString());
+  CHECK_THROWS(lean.rewind(0));
+}
+
+TEST_CASE("Count solutions") {
+  using namespace sudoku;
+
+  const std::string hardest
+      = "8..........36......7..9.2...5...7.......457.....1...3...1....68..85...1..9....4..";
+  Sudoku game(hardest);
+  Board solution;
+  CHECK(game.countSolutions(2, {&solution, 1}) == 1);
+  CHECK(boardToString(solution)
+        == "812753649943682175675491283154237896369845721287169534521974368438526917796318452");
+  // The board itself is left alone
+  CHECK(game.toString() == hardest);
+
+  // One clue less and the puzzle has several solutions, the count stops at the limit
+  Sudoku open("...........36......7..9.2...5...7.......457.....1...3...1....68..85...1..9....4..");
+  CHECK(open.countSolutions() == 2);
+  CHECK(open.countSolutions(5) == 5);
+  CHECK(open.countSolutions(0) == 0);
+
+  // Two 8s in the first row
+  std::string broken = hardest;
+  broken[1] = '8';
+  CHECK(Sudoku(broken).countSolutions() == 0);
+
+  // Every 4x4 grid
+  BasicSudoku<2> empty(std::string(16, '.'));
+  CHECK(empty.countSolutions(1000) == 288);
+}
+
+namespace {
+
+  template <size_t BOX> void solveBoardOfSize() {
+    using namespace sudoku;
+    constexpr size_t SIZE = BOX * BOX;
+
+    // A valid grid by shifting rows, with a diagonal pattern of cells blanked
+    std::string solution;
+    std::string puzzle;
+    for (size_t row = 0; row < SIZE; row++) {
+      for (size_t col = 0; col < SIZE; col++) {
+        int digit = static_cast<int>((((row % BOX) * BOX) + (row / BOX) + col) % SIZE) + 1;
+        solution.push_back(digitChar(digit));
+        puzzle.push_back((row + (2 * col)) % 3 == 0 ? solution.back() : '.');
+      }
+    }
+
+    BasicSudoku<BOX> game(puzzle);
+    CHECK(game.solve(SolveMode::LogicThenSearch));
+    std::string result = game.toString();
+    CHECK(result.size() == SIZE * SIZE);
+    CHECK(parseBoard<BOX>(result).isConsistent());
+    for (size_t cell = 0; cell < puzzle.size(); cell++) {
+      CHECK((puzzle[cell] == '.' || puzzle[cell] == result[cell]));
+    }
+
+    CHECK_THROWS_AS(BasicSudoku<BOX>(puzzle.substr(1)), std::invalid_argument);
+    puzzle[0] = digitChar(static_cast<int>(SIZE) + 1);
+    CHECK_THROWS_AS(BasicSudoku<BOX>(puzzle), std::invalid_argument);
+  }
+
+}  // namespace
+
+TEST_CASE("Board sizes") {
+  solveBoardOfSize<2>();
+  solveBoardOfSize<4>();
+  solveBoardOfSize<5>();
+
+  // Letters take the digits above 9, in either case
+  auto board = sudoku::parseBoard<4>(std::string(255, '.') + "g");
+  CHECK(board.getCell(255) == sudoku::digitMask<std::uint16_t>(16));
+}
+
 TEST_CASE("Sudoku version") {
   static_assert(std::string_view(SUDOKU_VERSION) == std::string_view("1.0"));
   CHECK(std::string(SUDOKU_VERSION) == std::string("1.0"));
@@ -0,0 +1,44 @@
+#include <doctest/doctest.h>
+#include <sudoku/io.h>
+#include <sudoku/sudoku.h>
+#include <sudoku/trace.h>
+
+#include <string>
+#include <vector>
+
+TEST_CASE("Trace events") {
+  using namespace sudoku;
+
+  if (!Tracer::ENABLED) {
+    return;
+  }
+
+  const std::string puzzle
+      = "53..7....6..195....98....6.8...6...34..8.3..17...2...6.6....28....419..5....8..79";
+  std::vector<TraceEvent> events;
+  Sudoku game(puzzle);
+  game.setTraceSink([&events](const TraceEvent& event) { events.push_back(event); });
+  CHECK(game.solve());
+
+  // Replaying the eliminations on the initial board gives the solution
+  Board board = parseBoard(puzzle);
+  size_t placed = 0;
+  for (const auto& event : events) {
+    if (event.kind == TraceEvent::Kind::Eliminated) {
+      CHECK((board.getCell(event.cell) & event.digits) == event.digits);
+      board.removeCandidates(event.cell, event.digits);
+    } else if (event.kind == TraceEvent::Kind::Placed) {
+      CHECK(board.getCell(event.cell) == event.digits);
+      placed++;
+    }
+  }
+  CHECK(boardToString(board) == game.toString());
+  CHECK(placed == 81 - 30);
+
+  // An empty sink stops tracing
+  size_t count = events.size();
+  game.setTraceSink({});
+  game.load(puzzle);
+  CHECK(game.solve());
+  CHECK(events.size() == count);
+}